@@ -0,0 +1,60 @@
+#include <handlebars/dispatcher.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// cost of handing an argument to every handler of a chain, over payload size and chain length.
+// the payload is a std::vector<char> pushed as a temporary, so the event owns it
+
+using payload = std::vector<char>;
+
+volatile size_t sink = 0;
+
+template<typename ArgT>
+double
+ns_per_event(size_t payload_size, size_t chain_length)
+{
+  typename handlebars::dispatcher<int, ArgT>::instance_type events;
+  for (size_t h = 0; h < chain_length; ++h) {
+    events.connect(0, [](ArgT p) { sink = sink + p.size(); });
+  }
+  size_t count = std::max<size_t>(256, (size_t{ 1 } << 26) / (payload_size * chain_length));
+  double total = 0;
+  for (size_t i = 0; i < count; ++i) {
+    events.push_event(0, payload(payload_size, 'x'));
+    auto start = std::chrono::steady_clock::now();
+    events.respond();
+    total += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  }
+  return total / count;
+}
+
+template<typename ArgT>
+void
+table(const char* name)
+{
+  const size_t sizes[] = { 64, 1024, 16 * 1024, 256 * 1024 };
+  const size_t chains[] = { 1, 2, 4, 8 };
+  std::printf("\n%s, ns per event (respond only)\n%10s", name, "bytes");
+  for (auto c : chains) {
+    std::printf(" %9zu handlers", c);
+  }
+  std::printf("\n");
+  for (auto s : sizes) {
+    std::printf("%10zu", s);
+    for (auto c : chains) {
+      std::printf(" %18.0f", ns_per_event<ArgT>(s, c));
+    }
+    std::printf("\n");
+  }
+}
+
+int
+main()
+{
+  table<payload&&>("rvalue reference (payload&&)");
+  table<payload>("value (payload)");
+  table<const payload&>("const reference (const payload&)");
+  return 0;
+}
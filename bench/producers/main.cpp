@@ -0,0 +1,78 @@
+#include <handlebars/dispatcher.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// measures push_event throughput as the number of producer threads grows, while one consumer keeps responding.
+// "locked" is a plain dispatcher behind one global mutex, "lock-free" is a concurrent_dispatcher
+
+using locked = handlebars::dispatcher<int, int>;
+using lock_free = handlebars::concurrent_dispatcher<int, int>;
+
+constexpr size_t events_per_producer = 200000;
+
+std::mutex global_lock;
+std::atomic<size_t> handled = 0;
+
+template<typename PushT, typename RespondT>
+double
+run(size_t producers, PushT push, RespondT respond)
+{
+  std::atomic<bool> producing = true;
+  std::thread consumer([&] {
+    while (producing) {
+      respond();
+    }
+    respond();
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (size_t i = 0; i < events_per_producer; ++i) {
+        push(static_cast<int>(p));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  producing = false;
+  consumer.join();
+  return (producers * events_per_producer) / elapsed / 1e6;
+}
+
+int
+main()
+{
+  size_t max_producers = std::max(2u, std::thread::hardware_concurrency());
+  for (int signal = 0; signal < static_cast<int>(max_producers); ++signal) {
+    locked::connect(signal, [](int) { ++handled; });
+    lock_free::connect(signal, [](int) { ++handled; });
+  }
+
+  std::printf("%10s %18s %18s\n", "producers", "locked Mevents/s", "lock-free Mevents/s");
+  for (size_t producers = 1; producers <= max_producers; producers *= 2) {
+    double with_lock = run(
+      producers,
+      [](int signal) {
+        std::lock_guard<std::mutex> guard(global_lock);
+        locked::push_event(signal, signal);
+      },
+      [] {
+        std::lock_guard<std::mutex> guard(global_lock);
+        locked::respond();
+      });
+    double without_lock = run(
+      producers, [](int signal) { lock_free::push_event(signal, signal); }, [] { lock_free::respond(); });
+    std::printf("%10zu %18.2f %18.2f\n", producers, with_lock, without_lock);
+  }
+  return 0;
+}
@@ -0,0 +1,544 @@
+#include <handlebars/dispatcher.hpp>
+#include <handlebars/event_bus.hpp>
+#include <handlebars/sharded_dispatcher.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// the dispatcher hot paths in one place, so changes to the dispatcher can be judged by numbers.
+// every line reports nanoseconds and global allocations per event (or per operation).
+// pass a word to only run the sections whose name contains it, like: handlebars_bench churn
+
+std::atomic<size_t> allocations = 0;
+
+// the replacements stay out of line, inlined malloc and free look mismatched with operator new and delete to gcc
+[[gnu::noinline]] void*
+operator new(size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void*
+operator new(size_t size, std::align_val_t align)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  auto alignment = static_cast<size_t>(align);
+  if (void* p = std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1))) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void
+operator delete(void* p, size_t) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void
+operator delete(void* p, std::align_val_t) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void
+operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+  std::free(p);
+}
+
+volatile size_t sink = 0;
+
+enum class signal
+{
+  first,
+  second,
+  third,
+  fourth
+};
+
+// times body(), which performs operations operations, and prints the per operation cost
+template<typename BodyT>
+void
+measure(const char* name, size_t operations, BodyT&& body)
+{
+  size_t allocated = allocations.load(std::memory_order_relaxed);
+  auto start = std::chrono::steady_clock::now();
+  body();
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  allocated = allocations.load(std::memory_order_relaxed) - allocated;
+  std::printf("  %-44s %10.1f ns %10.2f allocs\n", name, ns / operations, static_cast<double>(allocated) / operations);
+}
+
+constexpr size_t batch = 1024;
+constexpr size_t rounds = 200;
+constexpr size_t events = batch * rounds;
+
+void
+push_throughput()
+{
+  handlebars::dispatcher<int, int>::instance_type d;
+  d.connect(0, [](int v) { sink = sink + v; });
+  measure("push_event(int, int)", events, [&] {
+    for (size_t r = 0; r < rounds; ++r) {
+      for (size_t i = 0; i < batch; ++i) {
+        d.push_event(0, static_cast<int>(i));
+      }
+      d.update_events([](auto& queue) { queue.clear(); });
+    }
+  });
+
+  handlebars::basic_dispatcher<handlebars::policy::arena<>, int, int> arena;
+  arena.connect(0, [](int v) { sink = sink + v; });
+  measure("push_event(int, int), policy::arena", events, [&] {
+    for (size_t r = 0; r < rounds; ++r) {
+      for (size_t i = 0; i < batch; ++i) {
+        arena.push_event(0, static_cast<int>(i));
+      }
+      arena.respond();
+    }
+  });
+
+  std::vector<int> values(batch);
+  for (size_t i = 0; i < batch; ++i) {
+    values[i] = static_cast<int>(i);
+  }
+  measure("push_events(int, ints)", events, [&] {
+    for (size_t r = 0; r < rounds; ++r) {
+      d.push_events(0, values);
+      d.update_events([](auto& queue) { queue.clear(); });
+    }
+  });
+
+  handlebars::concurrent_dispatcher<int, int>::instance_type concurrent;
+  concurrent.connect(0, [](int v) { sink = sink + v; });
+  measure("push_event(int, int), policy::concurrent", events, [&] {
+    for (size_t r = 0; r < rounds; ++r) {
+      for (size_t i = 0; i < batch; ++i) {
+        concurrent.push_event(0, static_cast<int>(i));
+      }
+      concurrent.update_events([](auto& queue) { queue.clear(); });
+    }
+  });
+  measure("push_events(int, ints), policy::concurrent", events, [&] {
+    for (size_t r = 0; r < rounds; ++r) {
+      concurrent.push_events(0, values);
+      concurrent.update_events([](auto& queue) { queue.clear(); });
+    }
+  });
+}
+
+// push and respond, reporting the cost of respond alone
+template<typename DispatcherT, typename PushT>
+void
+measure_respond(const char* name, DispatcherT& d, PushT&& push)
+{
+  size_t allocated = 0;
+  double ns = 0;
+  for (size_t r = 0; r < rounds; ++r) {
+    for (size_t i = 0; i < batch; ++i) {
+      push(i);
+    }
+    size_t before = allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    d.respond();
+    ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    allocated += allocations.load(std::memory_order_relaxed) - before;
+  }
+  std::printf("  %-44s %10.1f ns %10.2f allocs\n", name, ns / events, static_cast<double>(allocated) / events);
+}
+
+void
+respond_latency()
+{
+  for (size_t length : { 1, 2, 4, 8, 16 }) {
+    handlebars::dispatcher<int, int>::instance_type d;
+    for (size_t h = 0; h < length; ++h) {
+      d.connect(0, [](int v) { sink = sink + v; });
+    }
+    std::string name = "respond, " + std::to_string(length) + " handler(s)";
+    measure_respond(name.c_str(), d, [&](size_t i) { d.push_event(0, static_cast<int>(i)); });
+  }
+}
+
+void
+emit_latency()
+{
+  handlebars::dispatcher<int, int>::instance_type d;
+  d.connect(0, [](int v) { sink = sink + v; });
+  measure("push_event + respond(1), 1 handler", events, [&] {
+    for (size_t i = 0; i < events; ++i) {
+      d.push_event(0, static_cast<int>(i));
+      d.respond(1);
+    }
+  });
+  measure("emit, 1 handler", events, [&] {
+    for (size_t i = 0; i < events; ++i) {
+      d.emit(0, static_cast<int>(i));
+    }
+  });
+  handlebars::dispatcher<int, const std::string&>::instance_type refs;
+  refs.connect(0, [](const std::string& s) { sink = sink + s.size(); });
+  std::string text(64, 'x');
+  measure("emit(int, const std::string&), 1 handler", events, [&] {
+    for (size_t i = 0; i < events; ++i) {
+      refs.emit(0, text);
+    }
+  });
+}
+
+void
+signal_types()
+{
+  {
+    handlebars::dispatcher<int, int>::instance_type d;
+    for (int s = 0; s < 4; ++s) {
+      d.connect(s, [](int v) { sink = sink + v; });
+    }
+    measure("push + respond, int signal", events, [&] {
+      for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < batch; ++i) {
+          d.push_event(static_cast<int>(i % 4), static_cast<int>(i));
+        }
+        d.respond();
+      }
+    });
+  }
+  {
+    handlebars::dispatcher<signal, int>::instance_type d;
+    for (int s = 0; s < 4; ++s) {
+      d.connect(static_cast<signal>(s), [](int v) { sink = sink + v; });
+    }
+    measure("push + respond, enum signal", events, [&] {
+      for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < batch; ++i) {
+          d.push_event(static_cast<signal>(i % 4), static_cast<int>(i));
+        }
+        d.respond();
+      }
+    });
+  }
+  {
+    // command names like the ones of example/repl
+    const std::string names[] = { "add", "subtract", "multiply", "print_result" };
+    handlebars::dispatcher<std::string, int>::instance_type d;
+    for (auto& name : names) {
+      d.connect(name, [](int v) { sink = sink + v; });
+    }
+    measure("push + respond, std::string signal", events, [&] {
+      for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < batch; ++i) {
+          d.push_event(names[i % 4], static_cast<int>(i));
+        }
+        d.respond();
+      }
+    });
+  }
+  {
+    // the same names interned, looked up from strings on every push like a command router would
+    const std::string names[] = { "add", "subtract", "multiply", "print_result" };
+    handlebars::symbol_dispatcher<int>::instance_type d;
+    for (auto& name : names) {
+      d.connect(name, [](int v) { sink = sink + v; });
+    }
+    measure("push + respond, symbol from std::string", events, [&] {
+      for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < batch; ++i) {
+          d.push_event(names[i % 4], static_cast<int>(i));
+        }
+        d.respond();
+      }
+    });
+    const handlebars::symbol symbols[] = { names[0], names[1], names[2], names[3] };
+    measure("push + respond, symbol signal", events, [&] {
+      for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < batch; ++i) {
+          d.push_event(symbols[i % 4], static_cast<int>(i));
+        }
+        d.respond();
+      }
+    });
+  }
+}
+
+template<typename ArgT, typename MakeT>
+void
+argument_category(const char* name, MakeT&& make)
+{
+  typename handlebars::dispatcher<int, ArgT>::instance_type d;
+  d.connect(0, [](ArgT s) { sink = sink + s.size(); });
+  d.connect(0, [](ArgT s) { sink = sink + s.size(); });
+  measure(name, events, [&] {
+    for (size_t r = 0; r < rounds; ++r) {
+      for (size_t i = 0; i < batch; ++i) {
+        make([&](auto&& payload) { d.push_event(0, std::forward<decltype(payload)>(payload)); });
+      }
+      d.respond();
+    }
+  });
+}
+
+void
+argument_categories()
+{
+  // long enough to not fit the small string buffer
+  std::string text(64, 'x');
+  auto temporary = [&](auto push) { push(std::string(text)); };
+  auto lvalue = [&](auto push) { push(text); };
+  std::printf("  (std::string payload of %zu bytes, 2 handlers)\n", text.size());
+  argument_category<std::string>("value (std::string), temporary", temporary);
+  argument_category<std::string>("value (std::string), lvalue", lvalue);
+  argument_category<std::string&&>("rvalue (std::string&&), temporary", temporary);
+  argument_category<const std::string&>("const reference, lvalue", lvalue);
+  argument_category<const std::string&>("const reference, temporary", temporary);
+  argument_category<std::string&>("reference (std::string&), lvalue", lvalue);
+}
+
+void
+churn()
+{
+  handlebars::dispatcher<int, int>::instance_type d;
+  d.connect(0, [](int v) { sink = sink + v; });
+  measure("connect + disconnect", events, [&] {
+    for (size_t i = 0; i < events; ++i) {
+      d.disconnect(d.connect(0, [](int v) { sink = sink + v; }));
+    }
+  });
+  std::vector<handlebars::dispatcher<int, int>::instance_type::handler_id_type> ids;
+  for (size_t i = 0; i < 64; ++i) {
+    ids.push_back(d.connect(0, [](int v) { sink = sink + v; }));
+  }
+  for (size_t i = 0; i < ids.size(); i += 2) {
+    d.disconnect(ids[i]);
+  }
+  measure_respond("respond after churn, 33 handlers", d, [&](size_t i) { d.push_event(0, static_cast<int>(i)); });
+}
+
+// producers push chunk events per call, one at a time with push_event when chunk is 1
+void
+producer_scaling(size_t chunk)
+{
+  size_t max_producers = std::max(2u, std::thread::hardware_concurrency());
+  for (size_t producers = 1; producers <= max_producers; producers *= 2) {
+    handlebars::concurrent_dispatcher<int, int>::instance_type d;
+    std::atomic<size_t> handled = 0;
+    d.connect(0, [&](int) { handled.fetch_add(1, std::memory_order_relaxed); });
+    size_t per_producer = events / producers;
+    std::string name = (chunk == 1) ? "concurrent push_event, " : "concurrent push_events of " + std::to_string(chunk) + ", ";
+    name += std::to_string(producers) + " producer(s)";
+    measure(name.c_str(), per_producer * producers, [&] {
+      std::atomic<bool> producing = true;
+      std::thread consumer([&] {
+        while (producing) {
+          d.respond();
+        }
+        d.respond();
+      });
+      std::vector<std::thread> threads;
+      for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&] {
+          if (chunk == 1) {
+            for (size_t i = 0; i < per_producer; ++i) {
+              d.push_event(0, static_cast<int>(i));
+            }
+            return;
+          }
+          std::vector<int> values(chunk);
+          for (size_t i = 0; i < per_producer; i += chunk) {
+            values.resize(std::min(chunk, per_producer - i));
+            d.push_events(0, values);
+          }
+        });
+      }
+      for (auto& t : threads) {
+        t.join();
+      }
+      producing = false;
+      consumer.join();
+    });
+  }
+}
+
+// handlers that do a little work, so consumers rather than producers are the bottleneck
+void
+busy_handler(int v)
+{
+  size_t x = static_cast<size_t>(v);
+  for (int i = 0; i < 200; ++i) {
+    x = x * 2862933555777941757ull + 3037000493ull;
+  }
+  sink = sink + x;
+}
+
+void
+sharding()
+{
+  size_t cores = std::max(2u, std::thread::hardware_concurrency());
+  constexpr int signals = 64;
+  auto produce = [&](auto& d) {
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < cores; ++p) {
+      threads.emplace_back([&, p] {
+        for (size_t i = 0; i < events / cores; ++i) {
+          d.push_event(static_cast<int>((p + i) % signals), static_cast<int>(i));
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  };
+  {
+    handlebars::concurrent_dispatcher<int, int>::instance_type d;
+    std::atomic<size_t> handled = 0;
+    for (int s = 0; s < signals; ++s) {
+      d.connect(s, [&](int v) {
+        busy_handler(v);
+        handled.fetch_add(1, std::memory_order_relaxed);
+      });
+    }
+    measure("1 consumer, busy handlers", events / cores * cores, [&] {
+      std::thread consumer([&] {
+        while (handled.load(std::memory_order_relaxed) < events / cores * cores) {
+          d.wait_and_respond(std::chrono::milliseconds(1));
+        }
+      });
+      produce(d);
+      consumer.join();
+    });
+  }
+  {
+    handlebars::sharded_dispatcher<int, int> d(cores);
+    std::atomic<size_t> handled = 0;
+    for (int s = 0; s < signals; ++s) {
+      d.connect(s, [&](int v) {
+        busy_handler(v);
+        handled.fetch_add(1, std::memory_order_relaxed);
+      });
+    }
+    std::string name = std::to_string(cores) + " shards, busy handlers";
+    measure(name.c_str(), events / cores * cores, [&] {
+      d.start();
+      produce(d);
+      while (handled.load(std::memory_order_relaxed) < events / cores * cores) {
+        std::this_thread::yield();
+      }
+      d.stop();
+    });
+  }
+}
+
+// every event matches one of many range subscriptions, matches are remembered per signal so the cost stays flat
+void
+pattern_subscriptions()
+{
+  {
+    handlebars::dispatcher<int, int>::instance_type d;
+    d.connect_any([](int v) { sink = sink + v; });
+    measure_respond("respond, connect_any", d, [&](size_t i) { d.push_event(static_cast<int>(i % 64), static_cast<int>(i)); });
+  }
+  for (size_t ranges : { 1, 16, 256 }) {
+    handlebars::dispatcher<int, int>::instance_type d;
+    for (size_t r = 0; r < ranges; ++r) {
+      int first = static_cast<int>(r * 4);
+      d.connect_range(first, first + 3, [](int v) { sink = sink + v; });
+    }
+    std::string name = "respond, " + std::to_string(ranges) + " connect_range";
+    measure_respond(name.c_str(), d, [&](size_t i) {
+      d.push_event(static_cast<int>(i % (ranges * 4)), static_cast<int>(i));
+    });
+  }
+}
+
+// three event signatures pushed round robin, responded to by their own dispatchers or through one bus
+void
+mixed_signatures()
+{
+  handlebars::dispatcher<int, int>::instance_type counts;
+  handlebars::dispatcher<int, const std::string&>::instance_type logs;
+  handlebars::dispatcher<int, double&, const double&>::instance_type sums;
+  for (int s = 0; s < 4; ++s) {
+    counts.connect(s, [](int v) { sink = sink + v; });
+    logs.connect(s, [](const std::string& text) { sink = sink + text.size(); });
+    sums.connect(s, [](double& total, const double& v) { total += v; });
+  }
+  std::string text(32, 'x');
+  double total = 0;
+  double value = 1.5;
+  measure("3 dispatchers, respond each", events, [&] {
+    for (size_t r = 0; r < rounds; ++r) {
+      for (size_t i = 0; i < batch; ++i) {
+        int s = static_cast<int>(i % 4);
+        switch (i % 3) {
+          case 0: counts.push_event(s, static_cast<int>(i)); break;
+          case 1: logs.push_event(s, text); break;
+          default: sums.push_event(s, total, value); break;
+        }
+      }
+      counts.respond();
+      logs.respond();
+      sums.respond();
+    }
+  });
+  handlebars::event_bus bus;
+  measure("event_bus, one respond in push order", events, [&] {
+    for (size_t r = 0; r < rounds; ++r) {
+      for (size_t i = 0; i < batch; ++i) {
+        int s = static_cast<int>(i % 4);
+        switch (i % 3) {
+          case 0: bus.push_event(counts, s, static_cast<int>(i)); break;
+          case 1: bus.push_event(logs, s, text); break;
+          default: bus.push_event(sums, s, total, value); break;
+        }
+      }
+      bus.respond();
+    }
+  });
+}
+
+int
+main(int argc, char** argv)
+{
+  struct section
+  {
+    const char* name;
+    void (*run)();
+  };
+  const section sections[] = { { "push", push_throughput },
+                               { "respond", respond_latency },
+                               { "emit", emit_latency },
+                               { "signals", signal_types },
+                               { "arguments", argument_categories },
+                               { "churn", churn },
+                               { "producers", [] { producer_scaling(1); } },
+                               { "producers, batched", [] { producer_scaling(64); } },
+                               { "sharding", sharding },
+                               { "bus", mixed_signatures },
+                               { "patterns", pattern_subscriptions } };
+  const char* filter = (argc > 1) ? argv[1] : "";
+  for (auto& s : sections) {
+    if (std::strstr(s.name, filter) != nullptr) {
+      std::printf("%s\n", s.name);
+      s.run();
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include <handlebars/dispatcher.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <string>
+
+// counts every global allocation, to show how many an event costs
+size_t allocations = 0;
+
+// the replacements stay out of line, inlined malloc and free look mismatched with operator new and delete to gcc
+[[gnu::noinline]] void*
+operator new(size_t size)
+{
+  ++allocations;
+  if (void* p = std::malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+// memory resources allocate with an explicit alignment
+[[gnu::noinline]] void*
+operator new(size_t size, std::align_val_t align)
+{
+  ++allocations;
+  if (void* p = std::aligned_alloc(static_cast<size_t>(align), (size + static_cast<size_t>(align) - 1) & ~(static_cast<size_t>(align) - 1))) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void
+operator delete(void* p, std::align_val_t) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void
+operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void
+operator delete(void* p, size_t) noexcept
+{
+  std::free(p);
+}
+
+template<typename DispatcherT, typename StringT>
+void
+measure(const char* name)
+{
+  DispatcherT events;
+  size_t characters = 0;
+  events.connect(0, [&](const StringT& line) { characters += line.size(); });
+
+  const int batches = 100, events_per_batch = 1000;
+  size_t before = allocations;
+  for (int b = 0; b < batches; ++b) {
+    for (int i = 0; i < events_per_batch; ++i) {
+      // the string argument is constructed inside the event, from the arena when there is one
+      events.push_event(0, "a log line long enough to not fit into a small string buffer");
+    }
+    events.respond(); // the arena is reset here, in one go
+  }
+  std::cout << name << ": " << static_cast<double>(allocations - before) / (batches * events_per_batch)
+            << " allocations per event\n";
+}
+
+int
+main()
+{
+  using heap = handlebars::basic_dispatcher<handlebars::policy::defaults, int, const std::string&>;
+  // a 256KiB arena holds a whole batch, strings are std::pmr::string so they allocate from it as well
+  using arena = handlebars::basic_dispatcher<handlebars::policy::arena<256 * 1024>, int, const std::pmr::string&>;
+
+  measure<heap, std::string>("std::string, default policy");
+  measure<arena, std::pmr::string>("std::pmr::string, arena policy");
+  return 0;
+}
@@ -0,0 +1,51 @@
+#include <handlebars/dispatcher.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+namespace policy = handlebars::policy;
+
+int
+main()
+{
+  // sensor readings where only the latest ones matter: at most 8 are kept, older readings make room for new ones
+  using readings = handlebars::basic_dispatcher<policy::bounded<8, policy::overflow::drop_oldest>, int, double>;
+  readings sensor;
+  sensor.connect(0, [](double value) { std::cout << "reading: " << value << "\n"; });
+  for (int i = 0; i < 20; ++i) {
+    sensor.push_event(0, i * 0.5);
+  }
+  sensor.respond(); // prints the last 8 readings
+  std::cout << "dropped " << sensor.overflow_counters().dropped_oldest << " readings\n";
+
+  // work items from several threads, producers wait while 64 items are pending
+  using work = handlebars::basic_dispatcher<policy::concurrent<policy::bounded<64, policy::overflow::block>>, int, int>;
+  work jobs;
+  std::atomic<long> done = 0;
+  jobs.connect(0, [&](int amount) { done += amount; });
+
+  std::atomic<bool> producing = true;
+  std::thread consumer([&] {
+    while (producing) {
+      jobs.respond();
+    }
+    jobs.respond();
+  });
+  std::thread producers[4];
+  for (auto& p : producers) {
+    p = std::thread([&] {
+      for (int i = 0; i < 10000; ++i) {
+        jobs.push_event(0, 1);
+      }
+    });
+  }
+  for (auto& p : producers) {
+    p.join();
+  }
+  producing = false;
+  consumer.join();
+  std::cout << "handled " << done << " work items, producers had to wait " << jobs.overflow_counters().blocked
+            << " times\n";
+  return 0;
+}
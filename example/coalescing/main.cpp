@@ -0,0 +1,40 @@
+#include <handlebars/dispatcher.hpp>
+
+#include <iostream>
+#include <string>
+
+enum class ui
+{
+  resize,
+  redraw,
+  log
+};
+
+int
+main()
+{
+  using events = handlebars::basic_dispatcher<handlebars::policy::defaults, ui, int, std::string>;
+  events window;
+
+  window.connect(ui::resize, [](int width, std::string) { std::cout << "resize to " << width << "\n"; });
+  window.connect(ui::redraw, [](int regions, std::string) { std::cout << "redraw " << regions << " regions\n"; });
+  window.connect(ui::log, [](int, std::string line) { std::cout << line << "\n"; });
+
+  // only the last size matters
+  window.coalesce(ui::resize);
+  // damaged regions add up
+  window.coalesce(ui::redraw, [](events::args_storage_type& pending, events::args_storage_type& incoming) {
+    std::get<0>(pending) += std::get<0>(incoming);
+  });
+
+  window.push_event(ui::log, 0, "dragging");
+  for (int width = 100; width <= 800; width += 100) {
+    window.push_event(ui::resize, width, "");
+    window.push_event(ui::redraw, 1, "");
+  }
+  window.push_event(ui::log, 0, "released");
+
+  // prints: dragging, resize to 800, redraw 8 regions, released
+  window.respond();
+  return 0;
+}
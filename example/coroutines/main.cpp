@@ -0,0 +1,73 @@
+#include <handlebars/dispatcher.hpp>
+
+#include <coroutine>
+#include <cstdio>
+#include <exception>
+#include <string>
+
+// a coroutine that starts right away and cleans up after itself, enough for flows driven by events
+struct task
+{
+  struct promise_type
+  {
+    task get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+enum class signal
+{
+  connected,
+  message
+};
+
+// messages from this sender end every session
+constexpr int everyone = -1;
+
+using events = handlebars::dispatcher<signal, int, const std::string&>;
+
+// reads one session from start to end as straight line code, suspended between events
+task
+session(int id)
+{
+  co_await events::next(signal::connected);
+  std::printf("session %d started\n", id);
+  int received = 0;
+  while (true) {
+    auto [from, text] = co_await events::next(signal::message);
+    if (from == everyone) {
+      break;
+    }
+    if (from == id) {
+      std::printf("session %d got \"%s\"\n", id, text.c_str());
+      if (++received == 2) {
+        break;
+      }
+    }
+  }
+  if (received == 2) {
+    std::printf("session %d done\n", id);
+  }
+}
+
+int
+main()
+{
+  // thousands of waiting sessions cost their coroutine frames, no threads
+  for (int id = 0; id < 1000; ++id) {
+    session(id);
+  }
+  events::push_event(signal::connected, 0, "");
+  events::respond();
+  for (int round = 0; round < 2; ++round) {
+    events::push_event(signal::message, 7, "hello");
+    events::push_event(signal::message, 512, "world");
+    events::respond();
+  }
+  events::push_event(signal::message, everyone, "bye");
+  events::respond();
+  return 0;
+}
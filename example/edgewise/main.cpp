@@ -1,18 +1,19 @@
 #include <handlebars/dispatcher.hpp>
 
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <thread>
 
 using namespace std::chrono_literals;
-using d = handlebars::dispatcher<int>;
+// push_event may be called from any thread, respond only from one
+using d = handlebars::concurrent_dispatcher<int>;
 
-bool is_running = true;
+std::atomic<bool> is_running = true;
 
 void
 talkative_thread()
 {
-  static auto id = d::connect(42, [] { is_running = false; });
   d::push_event(42);
   std::cout << "i got a word in edgewise!\n";
 }
@@ -27,17 +28,20 @@ responsive_thread()
   for (int i = 0; i < 100; ++i) {
     d::push_event(13);
   }
+  // sleeps while there is nothing to do instead of spinning, push_event wakes it up
   while (is_running) {
-    d::respond();
+    d::wait_and_respond(1s);
   }
 }
 
 int
 main()
 {
+  // handlers are connected before any other thread touches the dispatcher
+  d::connect(42, [] { is_running = false; });
   std::thread responder(&responsive_thread);
   std::this_thread::sleep_for(500ms);
   std::thread talker(&talkative_thread);
   responder.join();
   talker.join();
-}
\ No newline at end of file
+}
@@ -0,0 +1,50 @@
+#include <handlebars/fast/dispatcher.hpp>
+
+#include <iostream>
+
+// signals start at 0 and are followed by "enum_size", then the optional capacity settings
+enum class key
+{
+  up,
+  down,
+  left,
+  right,
+  enum_size,
+  max_handlers_per_signal = 2,
+  max_events_enqueued = 4
+};
+
+int
+main()
+{
+  using d = handlebars::fast::dispatcher<key, int&>;
+  int x = 0, y = 0;
+  d::connect(key::up, [&](int& steps) { y += steps; });
+  d::connect(key::down, [&](int& steps) { y -= steps; });
+  d::connect(key::left, [&](int& steps) { x -= steps; });
+  auto id = d::connect(key::right, [&](int& steps) { x += steps; });
+
+  int one = 1, two = 2;
+  d::push_event(key::up, two);
+  d::push_event(key::right, one);
+  d::push_event(key::right, one);
+  d::push_event(key::down, one);
+  if (!d::push_event(key::left, one)) { // the queue holds 4 events at most
+    std::cout << "queue is full\n";
+  }
+  d::respond();
+  std::cout << "x: " << x << " y: " << y << "\n"; // prints x: 2 y: 1
+
+  d::disconnect(id);
+  d::push_event(key::right, two);
+  d::respond();
+  std::cout << "x: " << x << " y: " << y << "\n"; // still x: 2 y: 1
+
+  // respond called by a handler does nothing, the outer call is still handling the event
+  d::connect(key::up, [&](int&) { std::cout << "nested respond: " << d::respond() << "\n"; }); // prints 0
+  d::push_event(key::up, one);
+  d::push_event(key::down, one);
+  size_t handled = d::respond();
+  std::cout << "handled: " << handled << " pending: " << d::events_pending() << "\n"; // prints handled: 2 pending: 0
+  return 0;
+}
@@ -0,0 +1,53 @@
+#include <handlebars/handles.hpp>
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// each worker owns a dispatcher instance, so the workers share no handlers, no queue and no locks
+using worker_dispatcher = handlebars::dispatcher<int, int>::instance_type;
+
+// a handler class connected to one specific instance instead of the global one
+struct counter : public handlebars::basic_handles<counter, worker_dispatcher>
+{
+  counter(worker_dispatcher& target)
+    : basic_handles(target)
+  {
+    connect(0, &counter::add);
+  }
+  void add(int amount) { total += amount; }
+
+  long total = 0;
+};
+
+int
+main()
+{
+  const int workers = 4;
+  std::vector<long> totals(workers);
+  std::vector<std::thread> threads;
+  for (int w = 0; w < workers; ++w) {
+    threads.emplace_back([w, &totals] {
+      worker_dispatcher events;
+      counter c(events);
+      for (int i = 0; i <= 1000; ++i) {
+        events.push_event(0, i * (w + 1));
+      }
+      events.respond();
+      totals[w] = c.total;
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (int w = 0; w < workers; ++w) {
+    std::cout << "worker " << w << ": " << totals[w] << "\n"; // 500500 * (w + 1)
+  }
+
+  // the static interface still works and uses its own default instance
+  handlebars::dispatcher<int, int>::connect(0, [](int v) { std::cout << "global: " << v << "\n"; });
+  handlebars::dispatcher<int, int>::push_event(0, 7);
+  handlebars::dispatcher<int, int>::respond();
+  return 0;
+}
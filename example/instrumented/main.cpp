@@ -0,0 +1,48 @@
+#include <handlebars/dispatcher.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+int
+main()
+{
+  using events = handlebars::basic_dispatcher<handlebars::policy::instrumented<>, std::string, int>;
+  events loop;
+
+  loop.connect("quick", [](int) {});
+  loop.connect("slow", [](int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); });
+  loop.connect("slow", [](int) {});
+
+  for (int frame = 0; frame < 20; ++frame) {
+    for (int i = 0; i < 100; ++i) {
+      loop.push_event("quick", i);
+    }
+    loop.push_event("slow", frame % 3);
+    loop.respond();
+  }
+
+  // a snapshot can be handed to another thread, printed here instead of being exported
+  auto stats = loop.statistics();
+  std::printf("at most %zu events were pending\n", stats.queue_high_water);
+  for (auto& signal : stats.signals) {
+    std::printf("%s: %zu pushed, %zu handled, queued p50 %lldns p99 %lldns\n",
+                signal.signal.c_str(),
+                signal.pushed,
+                signal.handled,
+                static_cast<long long>(signal.queue_latency.percentile(50).count()),
+                static_cast<long long>(signal.queue_latency.percentile(99).count()));
+    for (auto& handler : signal.handlers) {
+      std::printf("  handler %zu: ran %llu times, mean %lldns, max %lldns\n",
+                  handler.id.index,
+                  static_cast<unsigned long long>(handler.run_time.count()),
+                  static_cast<long long>(handler.run_time.mean().count()),
+                  static_cast<long long>(handler.run_time.max().count()));
+    }
+  }
+  loop.reset_statistics();
+  return 0;
+}
@@ -0,0 +1,93 @@
+#include <handlebars/dispatcher.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// a price tick of a symbol, journaled byte for byte
+struct tick
+{
+  double price;
+  int volume;
+};
+
+using feed = handlebars::basic_dispatcher<handlebars::policy::defaults, handlebars::symbol, tick>;
+
+// the handlers whose performance is measured, the same while recording and replaying
+void
+connect_handlers(feed& loop, double& turnover)
+{
+  for (const char* name : { "ACME", "INITECH", "UMBRELLA" }) {
+    loop.connect(name, [&turnover](tick t) { turnover += t.price * t.volume; });
+  }
+}
+
+// records a few seconds of a synthetic feed, which a real application would record from production traffic
+int
+record(const std::string& path)
+{
+  handlebars::journal_writer journal(path);
+  if (!journal.is_open()) {
+    std::fprintf(stderr, "cannot write %s\n", path.c_str());
+    return 1;
+  }
+  feed loop;
+  double turnover = 0;
+  connect_handlers(loop, turnover);
+  loop.record(journal);
+  for (int burst = 0; burst < 100; ++burst) {
+    for (int i = 0; i < 1000; ++i) {
+      loop.push_event((i % 3 == 0) ? "ACME" : (i % 3 == 1) ? "INITECH" : "UMBRELLA", tick{ 100.0 + i % 7, i });
+    }
+    loop.respond();
+    std::this_thread::sleep_for(10ms);
+  }
+  loop.stop_recording();
+  std::printf("recorded %zu events, %zu bytes\n", journal.records(), journal.bytes());
+  if (journal.dropped() > 0) {
+    std::fprintf(stderr, "%zu events did not fit into the journal\n", journal.dropped());
+  }
+  return 0;
+}
+
+// feeds a journal to the handlers again and reports how fast they kept up
+int
+replay(const std::string& path, handlebars::replay_timing timing)
+{
+  handlebars::journal_reader journal(path);
+  if (!journal.is_open()) {
+    std::fprintf(stderr, "%s is not a journal\n", path.c_str());
+    return 1;
+  }
+  feed loop;
+  double turnover = 0;
+  connect_handlers(loop, turnover);
+  auto stats = loop.replay(journal, timing);
+  std::printf("replayed %zu events in %.3fs, %.0f events/s (turnover %.0f)\n",
+              stats.events,
+              std::chrono::duration<double>(stats.elapsed).count(),
+              stats.events_per_second(),
+              turnover);
+  return 0;
+}
+
+// journal record <file>
+// journal replay <file> [original]
+int
+main(int argc, char** argv)
+{
+  if (argc >= 3 && std::strcmp(argv[1], "record") == 0) {
+    return record(argv[2]);
+  }
+  if (argc >= 3 && std::strcmp(argv[1], "replay") == 0) {
+    bool original = argc >= 4 && std::strcmp(argv[3], "original") == 0;
+    return replay(argv[2],
+                  original ? handlebars::replay_timing::original : handlebars::replay_timing::as_fast_as_possible);
+  }
+  std::fprintf(stderr, "usage: %s record <file> | replay <file> [original]\n", argv[0]);
+  return 1;
+}
@@ -0,0 +1,58 @@
+#include <handlebars/dispatcher.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// cpu heavy, independent handlers spread over a thread pool
+enum class job
+{
+  integrate,
+  sum_roots
+};
+
+std::atomic<long> completed = 0;
+
+double
+busy_work(int n)
+{
+  double acc = 0.0;
+  for (int i = 1; i < n; ++i) {
+    acc += std::sqrt(static_cast<double>(i)) / i;
+  }
+  return acc;
+}
+
+int
+main()
+{
+  using d = handlebars::dispatcher<job, int>;
+  d::connect(job::integrate, [](int n) {
+    busy_work(n);
+    ++completed;
+  });
+  d::connect(job::sum_roots, [](int n) {
+    busy_work(n / 2);
+    ++completed;
+  });
+
+  handlebars::thread_pool pool;
+  auto run = [&](const char* name, auto respond) {
+    for (int i = 0; i < 200; ++i) {
+      d::push_event((i % 2) ? job::integrate : job::sum_roots, 200000);
+    }
+    auto start = std::chrono::steady_clock::now();
+    respond();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << elapsed.count() << "ms\n";
+  };
+
+  run("sequential respond", [] { d::respond(); });
+  // events of one signal stay in order, different signals run in parallel
+  run("per signal fifo", [&] { d::respond(pool, handlebars::ordering::per_signal_fifo); });
+  // every event may run on any worker
+  run("unordered", [&] { d::respond(pool, handlebars::ordering::unordered); });
+  std::cout << completed << " events handled on " << pool.size() << " workers\n";
+  return 0;
+}
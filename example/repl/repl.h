@@ -36,7 +36,8 @@ tokenize(const std::string& input)
 
 struct repl
 {
-  using events = handlebars::dispatcher<std::string, std::vector<std::string>>;
+  // commands are interned symbols, so events carry an integer instead of a copy of the command name
+  using events = handlebars::symbol_dispatcher<std::vector<std::string>>;
   repl()
     : m_step(0)
     , m_active(true)
@@ -56,7 +57,12 @@ struct repl
   {
     if (input.size() > 0) {
       auto tokens = tokenize(input);
-      events::push_event(tokens[0], tokens);
+      // only known commands are looked up, typos do not grow the symbol table
+      if (auto command = handlebars::symbol::find(tokens[0])) {
+        events::push_event(*command, tokens);
+      } else {
+        std::cout << "unknown command: " << tokens[0] << "\n";
+      }
     }
     // do basic interpret step like: &&, ||, piping, multi command single data, etc...
     events::respond();
@@ -0,0 +1,39 @@
+#include <handlebars/dispatcher.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+int
+main()
+{
+  using events = handlebars::basic_dispatcher<handlebars::policy::defaults, std::string, int>;
+  events loop;
+  bool running = true;
+
+  loop.connect("tick", [](int n) { std::cout << "tick " << n << "\n"; });
+  loop.connect("timeout", [](int ms) { std::cout << "timed out after " << ms << "ms\n"; });
+  loop.connect("quit", [&](int) { running = false; });
+
+  auto ticks = loop.push_event_every(100ms, "tick", 0);
+  loop.push_event_after(250ms, "timeout", 250);
+  auto cancelled = loop.push_event_after(300ms, "timeout", 300);
+  loop.push_event_after(550ms, "quit", 0);
+  loop.cancel_timer(cancelled);
+
+  // thousands of timers cost no threads, respond pushes the events of due timers
+  for (int i = 0; i < 5000; ++i) {
+    loop.push_event_after(std::chrono::milliseconds(600 + i), "never", i);
+  }
+
+  while (running) {
+    loop.respond();
+    std::this_thread::sleep_for(1ms);
+  }
+  loop.cancel_timer(ticks);
+  std::cout << loop.timers_pending() << " timers left\n";
+  return 0;
+}
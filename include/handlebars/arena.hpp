@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace handlebars {
+inline namespace detail {
+
+// a monotonic buffer that events and their pmr-aware arguments are allocated from.
+// deallocation does nothing, the whole arena is handed back at once by release().
+// Bytes are allocated up front and reused after every release, only batches which outgrow them
+// reach the upstream (default) memory resource
+template<size_t Bytes>
+struct event_arena
+{
+  event_arena()
+    : m_buffer{ new std::byte[Bytes] }
+    , m_resource{ m_buffer.get(), Bytes }
+  {}
+  event_arena(const event_arena&) = delete;
+  event_arena& operator=(const event_arena&) = delete;
+
+  std::pmr::memory_resource* resource() { return &m_resource; }
+
+  // everything allocated from the arena must have been destroyed already
+  void release() { m_resource.release(); }
+
+private:
+  std::unique_ptr<std::byte[]> m_buffer;
+  std::pmr::monotonic_buffer_resource m_resource;
+};
+}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace handlebars {
+inline namespace detail {
+
+// counts the events of a bounded queue that concurrent producers push to.
+// producers reserve a slot before pushing, the consumer hands slots back after taking events off the queue.
+// the uncontended paths are a single atomic operation, only blocked producers touch the mutex
+template<size_t Capacity>
+struct capacity_gate
+{
+  // reserves a slot, false if the queue is full
+  bool try_acquire()
+  {
+    size_t used = m_used.load(std::memory_order_relaxed);
+    do {
+      if (used >= Capacity) {
+        return false;
+      }
+    } while (!m_used.compare_exchange_weak(used, used + 1, std::memory_order_acquire, std::memory_order_relaxed));
+    return true;
+  }
+
+  // reserves up to count slots at once, returns how many it got
+  size_t try_acquire(size_t count)
+  {
+    size_t used = m_used.load(std::memory_order_relaxed);
+    size_t granted;
+    do {
+      granted = (used >= Capacity) ? 0 : std::min(count, Capacity - used);
+      if (granted == 0) {
+        return 0;
+      }
+    } while (!m_used.compare_exchange_weak(used, used + granted, std::memory_order_acquire, std::memory_order_relaxed));
+    return granted;
+  }
+
+  // reserves a slot, waiting for the consumer to free one if the queue is full.
+  // returns false if it had to wait
+  bool acquire()
+  {
+    if (try_acquire()) {
+      return true;
+    }
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_waiting.fetch_add(1, std::memory_order_seq_cst);
+    // pairs with release, either this sees the slot handed back or release sees this waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    m_room.wait(guard, [this] { return try_acquire(); });
+    m_waiting.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // hands back slots of events that left the queue, wakes blocked producers
+  void release(size_t count)
+  {
+    if (count == 0) {
+      return;
+    }
+    m_used.fetch_sub(count, std::memory_order_seq_cst);
+    if (m_waiting.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> guard(m_lock);
+      m_room.notify_all();
+    }
+  }
+
+  // reserves slots without checking the capacity, for events the consumer puts back itself
+  void force_acquire(size_t count) { m_used.fetch_add(count, std::memory_order_relaxed); }
+
+  size_t used() const { return m_used.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<size_t> m_used{ 0 };
+  std::atomic<size_t> m_waiting{ 0 };
+  std::mutex m_lock;
+  std::condition_variable m_room;
+};
+}
+}
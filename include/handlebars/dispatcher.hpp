@@ -1,20 +1,65 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
 #include <optional>
 #include <queue>
+#include <thread>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define HANDLEBARS_COROUTINES 1
+#endif
+
 #include <callable.hpp>
 
+#include "arena.hpp"
+#include "capacity_gate.hpp"
+#include "handler_chain.hpp"
+#include "instrumentation.hpp"
+#include "interval_index.hpp"
+#include "journal.hpp"
+#include "mpsc_queue.hpp"
+#include "policy.hpp"
+#include "symbol.hpp"
+#include "thread_pool.hpp"
+#include "timer_wheel.hpp"
+#include "wakeup.hpp"
+
 namespace handlebars {
 
 		inline namespace detail {
 
+				// constructs a T from args, passing alloc along if T is allocator-aware (uses-allocator construction)
+				template<typename T, typename AllocT, typename... ArgTs>
+				T make_using_allocator(const AllocT& alloc, ArgTs&&... args)
+				{
+						if constexpr (!std::uses_allocator_v<T, AllocT>) {
+								return T(std::forward<ArgTs>(args)...);
+						}
+						else if constexpr (std::is_constructible_v<T, std::allocator_arg_t, const AllocT&, ArgTs...>) {
+								return T(std::allocator_arg, alloc, std::forward<ArgTs>(args)...);
+						}
+						else {
+								return T(std::forward<ArgTs>(args)..., alloc);
+						}
+				}
+
 				template<typename T>
 				struct fake_rval
 				{
@@ -27,13 +72,27 @@ namespace handlebars {
 						fake_rval(const T& ref)
 								: m_val{ ref }
 						{}
+						// used when events are allocated from an arena, see "policy.hpp"
+						template<typename AllocT, typename U>
+						fake_rval(std::allocator_arg_t, const AllocT& alloc, U&& value)
+								: m_val{ make_using_allocator<T>(alloc, std::forward<U>(value)) }
+						{}
+
+						// every handler but the last of a chain gets its own copy
+						operator T() const { return *m_val; }
 
-						operator T() const { return T{ m_val.value() }; }
+						// the last handler of a chain takes the stored value itself, see consume()
+						T&& take() { return std::move(*m_val); }
+
+						// the stored value, see peek()
+						const T& peek() const { return *m_val; }
 
 				private:
 						std::optional<T> m_val;
 				};
 
+				// refers either to an lvalue passed to push_event, or to its own copy of a temporary.
+				// the reference is resolved once at construction, reading it is a single indirection
 				template<typename T>
 				struct wrapped_const_ref
 				{
@@ -41,24 +100,46 @@ namespace handlebars {
 								: m_ref{ nullptr }
 						{}
 						wrapped_const_ref(T&& ref)
-								: m_ref{ std::move(ref) }
+								: m_val{ std::move(ref) }
+								, m_ref{ &*m_val }
 						{}
 						wrapped_const_ref(const T& ref)
 								: m_ref{ &ref }
 						{}
-
-						operator const T& () const
+						// used when events are allocated from an arena, an lvalue T is still referred to instead of copied
+						template<typename AllocT, typename U>
+						wrapped_const_ref(std::allocator_arg_t, const AllocT& alloc, U&& value)
 						{
-								if (std::holds_alternative<const T*>(m_ref)) {
-										return *std::get<const T*>(m_ref);
+								if constexpr (std::is_lvalue_reference_v<U> && std::is_same_v<std::decay_t<U>, T>) {
+										m_ref = &value;
 								}
 								else {
-										return std::get<T>(m_ref);
+										m_val.emplace(make_using_allocator<T>(alloc, std::forward<U>(value)));
+										m_ref = &*m_val;
 								}
 						}
+						wrapped_const_ref(const wrapped_const_ref& other)
+								: m_val{ other.m_val }
+								, m_ref{ m_val ? &*m_val : other.m_ref }
+						{}
+						wrapped_const_ref(wrapped_const_ref&& other)
+								: m_val{ std::move(other.m_val) }
+								, m_ref{ m_val ? &*m_val : other.m_ref }
+						{}
+						wrapped_const_ref& operator=(wrapped_const_ref other)
+						{
+								m_val = std::move(other.m_val);
+								m_ref = m_val ? &*m_val : other.m_ref;
+								return *this;
+						}
+
+						operator const T& () const { return *m_ref; }
+
+						const T& peek() const { return *m_ref; }
 
 				private:
-						const std::variant<T, const T*> m_ref;
+						std::optional<T> m_val;
+						const T* m_ref;
 				};
 
 				template<typename T>
@@ -76,6 +157,8 @@ namespace handlebars {
 								return (*m_ref);
 						}
 
+						const T& peek() const { return *m_ref; }
+
 				private:
 						T* m_ref;
 				};
@@ -102,11 +185,170 @@ namespace handlebars {
 				};
 				template<typename T>
 				using arg_storage_t = typename arg_storage<T>::type;
+
+				// what the last handler of a chain is called with: stored values and rvalues are moved out of the event
+				// instead of copied, references are passed as usual
+				template<typename T>
+				T&& consume(T& stored)
+				{
+						return std::move(stored);
+				}
+				template<typename T>
+				T&& consume(fake_rval<T>& stored)
+				{
+						return stored.take();
+				}
+				template<typename T>
+				wrapped_const_ref<T>& consume(wrapped_const_ref<T>& stored)
+				{
+						return stored;
+				}
+				template<typename T>
+				wrapped_ref<T>& consume(wrapped_ref<T>& stored)
+				{
+						return stored;
+				}
+
+				// whether signals of type T can be ordered with <, which connect_range needs
+				template<typename T, typename = void>
+				struct is_ordered : std::false_type
+				{};
+				template<typename T>
+				struct is_ordered<T, std::void_t<decltype(std::declval<const T&>() < std::declval<const T&>())>> : std::true_type
+				{};
+				template<typename T>
+				inline constexpr bool is_ordered_v = is_ordered<T>::value;
+
+				// the value an argument is stored as, without taking or copying it, for writing it to a journal
+				template<typename T>
+				const T& peek(const T& stored)
+				{
+						return stored;
+				}
+				template<typename T>
+				const T& peek(const fake_rval<T>& stored)
+				{
+						return stored.peek();
+				}
+				template<typename T>
+				const T& peek(const wrapped_const_ref<T>& stored)
+				{
+						return stored.peek();
+				}
+				template<typename T>
+				const T& peek(const wrapped_ref<T>& stored)
+				{
+						return stored.peek();
+				}
+
+				// the argument replay pushes for a handler taking T, decoded into value: references refer to the decoded
+				// value, which outlives the event, everything else is moved
+				template<typename T, typename ValueT>
+				decltype(auto) replayed(ValueT& value)
+				{
+						if constexpr (std::is_lvalue_reference_v<T>) {
+								return (value);
+						}
+						else {
+								return std::move(value);
+						}
+				}
+
+				// how an argument of type T is kept for a coroutine awaiting an event: mutable references keep referring to
+				// what was pushed, everything else is copied or moved out of the event
+				template<typename T>
+				struct awaited
+				{
+						using type = std::decay_t<T>;
+				};
+				template<typename T>
+				struct awaited<T&>
+				{
+						using type = T&;
+				};
+				template<typename T>
+				struct awaited<const T&>
+				{
+						using type = T;
+				};
+				template<typename T>
+				using awaited_t = typename awaited<T>::type;
+
+				// what a handler taking T is called with by emit, for an argument passed to emit as FwdT.
+				// like with events, every handler but the last gets its own copy of values and rvalues and the last one gets
+				// the argument itself, forwarded as it was passed
+				template<typename T, bool Last, typename FwdT>
+				decltype(auto) pass_on(std::remove_reference_t<FwdT>& arg)
+				{
+						if constexpr (std::is_lvalue_reference_v<T>) {
+								return (arg);
+						}
+						else if constexpr (Last && !std::is_lvalue_reference_v<FwdT>) {
+								return std::move(arg);
+						}
+						else if constexpr (std::is_rvalue_reference_v<T>) {
+								return std::remove_cv_t<std::remove_reference_t<T>>(arg);
+						}
+						else {
+								return (arg);
+						}
+				}
 		}
+}
 
-		template<typename SignalT, typename... HandlerArgTs>
-		struct dispatcher
+// argument wrappers take an allocator exactly when the type they store does
+namespace std {
+		template<typename T, typename AllocT>
+		struct uses_allocator<handlebars::fake_rval<T>, AllocT> : uses_allocator<T, AllocT>
+		{};
+		template<typename T, typename AllocT>
+		struct uses_allocator<handlebars::wrapped_const_ref<T>, AllocT> : uses_allocator<T, AllocT>
+		{};
+}
+
+namespace handlebars {
+
+		// how respond(thread_pool&, ...) may reorder events to handle them in parallel
+		enum class ordering
 		{
+				// events are handled one after another in the order they were pushed, on the calling thread
+				strict_fifo,
+				// events of the same signal are handled one after another in the order they were pushed,
+				// events of different signals are handled in parallel
+				per_signal_fifo,
+				// any event may be handled in parallel with any other event
+				unordered
+		};
+
+		// the priority of a pushed event, see policy::prioritized. higher levels are handled first
+		struct priority
+		{
+				size_t level = 0;
+		};
+
+		// how often a bounded dispatcher had to deal with a full queue, see policy::bounded
+		struct overflow_stats
+		{
+				// pushes that waited for room (overflow::block)
+				size_t blocked = 0;
+				// pushes that were turned away (overflow::reject, or overflow::coalesce without a matching event)
+				size_t rejected = 0;
+				// pending events discarded to make room (overflow::drop_oldest, overflow::drop_newest)
+				size_t dropped_oldest = 0;
+				size_t dropped_newest = 0;
+				// pushes that replaced a pending event (overflow::coalesce)
+				size_t coalesced = 0;
+		};
+
+		// a dispatcher instance owns its handler map and event queue, instances never share state.
+		// PolicyT configures event storage and thread safety, see "policy.hpp".
+		// most code will use the static interface through one of the aliases "dispatcher" or "concurrent_dispatcher"
+		// declared below, which forward to a default instance of this class
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		struct alignas(64) basic_dispatcher
+		{
+				// see "policy.hpp"
+				using policy_type = PolicyT;
 				// signal differentiaties the type of event that is happening
 				// preferably use a type that is cheap to copy
 				using signal_type = SignalT;
@@ -116,244 +358,2558 @@ namespace handlebars {
 				// this tuple holds the data which will be passed to the handler
 				using args_storage_type = std::tuple<arg_storage_t<HandlerArgTs>...>;
 				// a handler chain is a sequence of handlers that will be called consecutively to handle an event.
-				using handler_chain_type = std::vector<std::optional<handler_type>>;
-				// handler id  is a signal and an iterator to a handler packed together to make handler removal easier when calling
-				// "disconnect" globally or from handler base class
+				// see "handler_chain.hpp"
+				using handler_chain_type = handler_chain<handler_type>;
+				// handler id  is a signal and a slot of its handler chain packed together to make handler removal easier when calling
+				// "disconnect" globally or from handler base class. the generation tells a reused slot from the one the id was for
 				struct handler_id_type
 				{
 						SignalT signal;
 						size_t index;
+						size_t generation;
+						// set for handlers of connect_any, connect_range and connect_if, whose signal is the first of the range
+						// or SignalT{}
+						bool pattern = false;
 				};
 				// handler map, simply maps signals to their corresponding handler chains
 				using handler_map_type = std::unordered_map<SignalT, handler_chain_type>;
-				// events hold all relevant data to call a handler list
-				struct event_type
+				// events hold all relevant data to call a handler list.
+				// with policy::instrumented they also carry the time they were pushed at
+				struct event_type : push_stamp<PolicyT::collect_statistics>
 				{
 						signal_type signal;
 						args_storage_type args;
 				};
 
-				// event queue is a modify-able fifo queue that stores events
-				using event_queue_type = std::deque<event_type>;
+				// the clock timers are scheduled with
+				using clock_type = std::chrono::steady_clock;
+
+				// identifies a timer scheduled with push_event_at, push_event_after or push_event_every
+				using timer_id_type = typename timer_wheel<event_type>::id_type;
+
+				// decides whether a handler of connect_if is called for events of a signal
+				using predicate_type = tmf::callable<bool(const SignalT&)>;
+
+				// merges an event that was just pushed into a pending event of the same signal, see coalesce
+				using merge_type = tmf::callable<void(args_storage_type& pending, args_storage_type& incoming)>;
+
+				// what policy::instrumented records about a handler, a signal and the whole dispatcher, see statistics()
+				struct handler_statistics
+				{
+						handler_id_type id;
+						latency_histogram run_time;
+				};
+				struct signal_statistics
+				{
+						SignalT signal;
+						// events queued, including those coalesced into a pending event
+						size_t pushed = 0;
+						size_t handled = 0;
+						// from push_event (or a timer becoming due) until respond takes the event
+						latency_histogram queue_latency;
+						std::vector<handler_statistics> handlers;
+				};
+				struct statistics_type
+				{
+						// the most events that were pending at once
+						size_t queue_high_water = 0;
+						std::vector<signal_statistics> signals;
+						// handlers of connect_any, connect_range and connect_if, over all signals they were called for
+						std::vector<handler_statistics> patterns;
+				};
+
+				// event queue is a modify-able fifo queue that stores events, it allocates from the arena if the policy has one
+				using event_queue_type = std::conditional_t<(PolicyT::arena_bytes > 0),
+						std::deque<event_type, std::pmr::polymorphic_allocator<event_type>>,
+						std::deque<event_type>>;
+
+				basic_dispatcher() = default;
+				// handler ids and "handles" refer to an instance by address, so instances stay where they are created
+				basic_dispatcher(const basic_dispatcher&) = delete;
+				basic_dispatcher& operator=(const basic_dispatcher&) = delete;
+
+				// the instance used by the static interface of "global_dispatcher", created on first use
+				static basic_dispatcher& default_instance();
 
 				// associates a SignalT signal with a callable entity (any lambda, free function, static member function
 				// or function object)
 				template<typename HandlerT>
-				static handler_id_type connect(const SignalT& signal, HandlerT&& handler);
+				handler_id_type connect(const SignalT& signal, HandlerT&& handler);
 
 				// associates a SignalT signal with a callable entity, after binding arguments to it
 				template<typename HandlerT, typename... BoundArgTs>
-				static handler_id_type connect_bind(const SignalT& signal, HandlerT&& handler, BoundArgTs&&... bound_args);
+				handler_id_type connect_bind(const SignalT& signal, HandlerT&& handler, BoundArgTs&&... bound_args);
 
 				// associates a SignalT signal with a member function pointer of a class instance
 				// ClassT must be either a raw pointer or shared_ptr
 				template<typename ClassT, typename MemPtrT>
-				static handler_id_type connect_member(const SignalT& signal, ClassT&& object, MemPtrT member);
+				handler_id_type connect_member(const SignalT& signal, ClassT&& object, MemPtrT member);
 
 				// associates a SignalT signal with a member function pointer of a class instance, after binding arguments to it
 				// ClassT must be either a raw pointer or shared_ptr
 				template<typename ClassT, typename MemPtrT, typename... BoundArgTs>
-				static handler_id_type connect_bind_member(const SignalT& signal,
+				handler_id_type connect_bind_member(const SignalT& signal,
 						ClassT&& object,
 						MemPtrT member,
 						BoundArgTs&&... bound_args);
 
-				// pushes a new event onto the queue with a signal value and arguments, if any
+				// pattern handlers are called for the events of many signals, after the handlers connected to the signal itself
+				// and in the order they were connected. they live apart from the handler map: which pattern handlers match a
+				// signal is worked out once, with an interval index over the ranges, and remembered until pattern handlers
+				// are connected or disconnected. changes made while handlers run apply from the next respond.
+				// disconnect them like any other handler
+
+				// associates every signal with a callable entity
+				template<typename HandlerT>
+				handler_id_type connect_any(HandlerT&& handler);
+
+				// associates the signals from first to last, both included, with a callable entity. SignalT must have operator<
+				template<typename HandlerT>
+				handler_id_type connect_range(const SignalT& first, const SignalT& last, HandlerT&& handler);
+
+				// associates the signals predicate returns true for with a callable entity. predicate is asked once per signal
+				// and its answer remembered, so it must always give the same answer for a signal
+				template<typename HandlerT>
+				handler_id_type connect_if(predicate_type predicate, HandlerT&& handler);
+
+				// pushes a new event onto the queue with a signal value and arguments, if any.
+				// with a concurrent policy this may be called from any number of threads at once.
+				// returns false if a bounded policy turned the event away, see "policy.hpp"
 				template<typename... FwdHandlerArgTs>
-				static void push_event(const SignalT& signal, FwdHandlerArgTs&&... args);
+				bool push_event(const SignalT& signal, FwdHandlerArgTs&&... args);
 
-				// returns the size of the event queue
-				static size_t events_pending();
+				// like push_event(signal, args...), but the event is handled before all pending events of lower priority.
+				// levels above the highest level of policy::prioritized are clamped to it, without that policy it is ignored
+				template<typename... FwdHandlerArgTs>
+				bool push_event(priority prio, const SignalT& signal, FwdHandlerArgTs&&... args);
+
+				// pushes an event of signal for every element of range, which holds the argument if the event signature has
+				// one and tuples of the arguments otherwise. the same as calling push_event for every element, but with a
+				// concurrent policy the whole batch is handed to the queue at once, and a bounded policy reserves room once.
+				// elements are moved out of an rvalue range. range must be a forward range (vector, array, span...).
+				// returns how many events were pushed
+				template<typename RangeT>
+				size_t push_events(const SignalT& signal, RangeT&& range);
+
+				// like push_events(signal, range), range holds tuples of a signal followed by the arguments
+				template<typename RangeT>
+				size_t push_events(RangeT&& range);
+
+				// calls the handlers of signal with args right away, on the calling thread and without queueing an event.
+				// arguments are passed on like push_event would store them, minus the storage. may be called from handlers
+				// of a sequential respond, and like connect only from the responding thread
+				template<typename... FwdHandlerArgTs>
+				void emit(const SignalT& signal, FwdHandlerArgTs&&... args);
+
+				// pushes the event once due has passed, the first respond call from then on handles it.
+				// timers cost no threads, they are kept in a timer wheel which respond advances.
+				// arguments are stored like with push_event, references must stay valid until the event is handled
+				template<typename... FwdHandlerArgTs>
+				timer_id_type push_event_at(clock_type::time_point due, const SignalT& signal, FwdHandlerArgTs&&... args);
+
+				// like push_event_at, once delay has passed
+				template<typename... FwdHandlerArgTs>
+				timer_id_type push_event_after(clock_type::duration delay, const SignalT& signal, FwdHandlerArgTs&&... args);
+
+				// pushes a copy of the event every period, starting one period from now, until the timer is cancelled
+				template<typename... FwdHandlerArgTs>
+				timer_id_type push_event_every(clock_type::duration period, const SignalT& signal, FwdHandlerArgTs&&... args);
+
+				// stops a timer, returns false if it already pushed its event (once) or was cancelled
+				bool cancel_timer(const timer_id_type& timer_id);
+
+				// timers that are neither due nor cancelled
+				size_t timers_pending() const;
+
+				// returns the size of the event queue. with a concurrent policy any thread may ask, producers get a count which
+				// is approximate while respond is collecting their events
+				size_t events_pending() const;
+
+				// how often the overflow action of a bounded policy fired, all zero for unbounded policies
+				overflow_stats overflow_counters() const;
+
+				// from now on, an event pushed while an event of the same signal is still pending replaces the pending one,
+				// so a burst of pushes costs a single dispatch. the pending event keeps its place in the queue.
+				// with a concurrent policy events are coalesced when respond collects them from producers
+				void coalesce(const SignalT& signal);
+
+				// like coalesce(signal), but merge is called to combine the pending events arguments with the new ones
+				// instead of replacing them
+				void coalesce(const SignalT& signal, merge_type merge);
+
+				// events of signal are queued one by one again
+				void stop_coalescing(const SignalT& signal);
 
 				// handles events and pops them off of the event queue.
 				// the amount can be specified by limit.
 				// if limit is 0, then all events are executed.
 				// returns number of events that were succesfully handled
-				static size_t respond(size_t limit = 0);
+				size_t respond(size_t limit = 0);
 
-				//  this removes an event handler from a handler list
-				static void disconnect(const handler_id_type& handler_id);
+				// handles whole events until deadline has passed, the rest stay queued for the next call.
+				// the clock is read before every event, so one long handler can still overrun the deadline.
+				// returns number of events that were handled
+				size_t respond_until(clock_type::time_point deadline);
 
-				// this function lets you modify the event queue in a thread aware manner
-				static void update_events(const tmf::callable<void(event_queue_type&)>& updater);
+				// like respond_until, with a deadline of budget from now
+				size_t respond_for(clock_type::duration budget);
 
-		private:
-				dispatcher() {}
+				// sleeps until events are pushed (by producers of a concurrent policy), a timer is due or timeout has
+				// passed, then responds to all pending events. returns number of events that were handled, 0 on timeout or wake.
+				// like respond, returns 0 right away when called from a handler of this dispatcher
+				size_t wait_and_respond(clock_type::duration timeout);
 
-				inline static handler_map_type m_handler_map{};
-				inline static std::unordered_map<SignalT, std::vector<size_t>> m_unused_handler_storage_indices;
-				inline static event_queue_type m_event_queue{};
-		};
-}
+				// makes a running wait_and_respond call return early, or the next one if none is running. any thread
+				void wake();
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////Implementation//////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+				// forgets a wake that no wait_and_respond call has returned for yet, once the thread that was woken is done.
+				// call it from the responding thread
+				void clear_wake();
 
-namespace handlebars {
+				// a file descriptor that is readable while events are waiting for respond, to wait for them in an existing
+				// epoll or poll loop instead of wait_and_respond. respond makes it unreadable again, so nothing else should
+				// read it. -1 where eventfd is not available. created by the first call, which belongs to the responding thread
+				int wakeup_handle();
 
-		template<typename SignalT, typename... HandlerArgTs>
-		template<typename HandlerT>
-		typename dispatcher<SignalT, HandlerArgTs...>::handler_id_type
-				dispatcher<SignalT, HandlerArgTs...>::connect(const SignalT& signal, HandlerT&& handler)
-		{
-				handler_id_type handler_id;
-				if (m_unused_handler_storage_indices[signal].size() > 0) {
-						handler_id = { signal, m_unused_handler_storage_indices[signal].back() };
-						m_unused_handler_storage_indices[signal].pop_back();
-						m_handler_map[signal].emplace(
-								m_handler_map[signal].begin() + handler_id.index, std::in_place, std::forward<HandlerT>(handler));
-				}
-				else {
-						handler_id = { signal, m_handler_map[signal].size() };
-						m_handler_map[signal].emplace_back(std::in_place, std::forward<HandlerT>(handler));
-				}
-				return handler_id;
-		}
+				// the earliest time respond may have timer events to push, clock_type::time_point::max() without timers.
+				// meant as the timeout of a poll loop, may be a little early but never late
+				clock_type::time_point next_timer_due() const;
 
-		template<typename SignalT, typename... HandlerArgTs>
-		template<typename HandlerT, typename... BoundArgTs>
-		typename dispatcher<SignalT, HandlerArgTs...>::handler_id_type
-				dispatcher<SignalT, HandlerArgTs...>::connect_bind(const SignalT& signal,
-						HandlerT&& handler,
-						BoundArgTs&&... bound_args)
-		{
-				handler_id_type handler_id;
-				if (m_unused_handler_storage_indices[signal].size() > 0) {
-						handler_id = { signal, m_unused_handler_storage_indices[signal].back() };
-						m_unused_handler_storage_indices[signal].pop_back();
-						m_handler_map[signal].emplace(
-								m_handler_map[signal].begin() + handler_id.index,
-								std::in_place,
-								[&, bound_tuple = std::forward_as_tuple(std::forward<BoundArgTs>(bound_args)...)](HandlerArgTs&&... args) {
-								std::apply(handler, std::tuple_cat(bound_tuple, std::make_tuple(std::forward<HandlerArgTs>(args)...)));
-						});
-				}
-				else {
-						handler_id = { signal, m_handler_map[signal].size() };
-						m_handler_map[signal].emplace_back(
-								std::in_place,
-								[&, bound_tuple = std::forward_as_tuple(std::forward<BoundArgTs>(bound_args)...)](HandlerArgTs&&... args) {
-								std::apply(handler, std::tuple_cat(bound_tuple, std::make_tuple(std::forward<HandlerArgTs>(args)...)));
-						});
-				}
-				return handler_id;
-		}
+				// like respond(limit), but hands events to the workers of pool as allowed by order.
+				// every handler that can run in parallel must be thread safe. handlers must not connect or disconnect,
+				// and may only push events to this dispatcher if its policy allows concurrent producers.
+				// returns once all handled events are finished
+				size_t respond(thread_pool& pool, ordering order = ordering::per_signal_fifo, size_t limit = 0);
 
-		template<typename SignalT, typename... HandlerArgTs>
-		template<typename ClassT, typename MemPtrT>
-		typename dispatcher<SignalT, HandlerArgTs...>::handler_id_type
-				dispatcher<SignalT, HandlerArgTs...>::connect_member(const SignalT& signal, ClassT&& object, MemPtrT member)
-		{
-				handler_id_type handler_id;
-				if (m_unused_handler_storage_indices[signal].size() > 0) {
-						handler_id = { signal, m_unused_handler_storage_indices[signal].back() };
-						m_unused_handler_storage_indices[signal].pop_back();
-						m_handler_map[signal].emplace(
-								m_handler_map[signal].begin() + handler_id.index, std::in_place, std::forward<ClassT>(object), member);
-				}
-				else {
-						handler_id = { signal, m_handler_map[signal].size() };
-						m_handler_map[signal].emplace_back(std::in_place, std::forward<ClassT>(object), member);
-				}
-				return handler_id;
-		}
+				// this removes an event handler from a handler list in O(1).
+				// returns false if the handler was disconnected already, the id of a disconnected handler never matches another one
+				bool disconnect(const handler_id_type& handler_id);
 
-		template<typename SignalT, typename... HandlerArgTs>
-		template<typename ClassT, typename MemPtrT, typename... BoundArgTs>
-		typename dispatcher<SignalT, HandlerArgTs...>::handler_id_type
-				dispatcher<SignalT, HandlerArgTs...>::connect_bind_member(const SignalT& signal,
-						ClassT&& object,
-						MemPtrT member,
-						BoundArgTs&&... bound_args)
-		{
-				handler_id_type handler_id;
-				if (m_unused_handler_storage_indices[signal].size() > 0) {
-						handler_id = { signal, m_unused_handler_storage_indices[signal].back() };
-						m_unused_handler_storage_indices[signal].pop_back();
-						m_handler_map[signal].emplace(
-								m_handler_map[signal].begin() + handler_id.index,
-								std::in_place,
-								[=, bound_tuple = std::forward_as_tuple(std::forward<BoundArgTs>(bound_args)...)](HandlerArgTs&&... args) {
-								std::apply(function(std::forward<ClassT>(object), member),
-										std::tuple_cat(bound_tuple, std::forward_as_tuple(std::forward<HandlerArgTs>(args)...)));
-						});
-				}
-				else {
-						handler_id = { signal, m_handler_map[signal].size() };
-						m_handler_map[signal].emplace_back(
-								std::in_place,
-								[=, bound_tuple = std::forward_as_tuple(std::forward<BoundArgTs>(bound_args)...)](HandlerArgTs&&... args) {
-								std::apply(function(std::forward<ClassT>(object), member),
-										std::tuple_cat(bound_tuple, std::forward_as_tuple(std::forward<HandlerArgTs>(args)...)));
-						});
-				}
-				return handler_id;
-		}
+				// a snapshot of what policy::instrumented recorded, call it from the responding thread between respond calls
+				// and hand the copy to whatever exports it
+				statistics_type statistics() const;
 
-		template<typename SignalT, typename... HandlerArgTs>
-		template<typename... FwdHandlerArgTs>
-		void
-				dispatcher<SignalT, HandlerArgTs...>::push_event(const SignalT& signal, FwdHandlerArgTs&&... args)
-		{
-				m_event_queue.emplace_back(event_type{
-						signal, args_storage_type{ std::forward<FwdHandlerArgTs>(args)... } });
-		}
+				// starts recording from zero
+				void reset_statistics();
 
-		template<typename SignalT, typename... HandlerArgTs>
-		size_t
-				dispatcher<SignalT, HandlerArgTs...>::events_pending()
-		{
-				size_t qsize = m_event_queue.size();
-				return qsize;
-		}
+				// this function lets you modify the event queue in a thread aware manner.
+				// with a concurrent policy, events still in flight from producers are collected first and
+				// this must be called from the responding thread.
+				// with policy::prioritized only events of priority 0 are in this queue
+				void update_events(const tmf::callable<void(event_queue_type&)>& updater);
 
-		template<typename SignalT, typename... HandlerArgTs>
-		size_t
-				dispatcher<SignalT, HandlerArgTs...>::respond(size_t limit)
-		{
-				size_t progress = 0;
+				// from now on writes every event to journal as it is queued, see "journal.hpp": events of concurrent producers
+				// when respond collects them, timer events once they are due. events a bounded queue turns away are recorded
+				// too, a journal holds what was pushed. the signal and arguments are written by their journal_codec.
+				// journal must stay open until stop_recording, call both from the responding thread
+				void record(journal_writer& journal);
 
-				if (limit == 0) { // respond to an unlimited amount of events
-						for (auto& e : m_event_queue) {
-								for (auto& h : m_handler_map[e.signal]) {
-										if (h.has_value()) {
-												std::apply(h.value(), e.args);
-										}
+				void stop_recording();
+
+				// pushes the events of journal from its next record on and responds to them, see replay_timing.
+				// events keep their priority level, references handlers take refer to values decoded from the journal.
+				// call it from the responding thread, returns how many events the queue accepted and how long that took
+				replay_stats replay(journal_reader& journal, replay_timing timing = replay_timing::as_fast_as_possible);
+
+#ifdef HANDLEBARS_COROUTINES
+				// what next(signal) returns. co_await suspends the coroutine until an event of signal is handled and
+				// resumes it from within respond (or emit), the result is a tuple of the event arguments, see awaited_t.
+				// while suspended the coroutine is a one-shot handler of signal, which lives in the awaiter in the
+				// coroutine frame and is disconnected when it fires or when the coroutine is destroyed
+				struct next_awaiter
+				{
+						using result_type = std::tuple<awaited_t<HandlerArgTs>...>;
+
+						next_awaiter(basic_dispatcher& dispatcher, const SignalT& signal)
+								: m_dispatcher{ &dispatcher }
+								, m_signal{ signal }
+						{}
+						// the handler refers to the awaiter, so it stays where it was constructed
+						next_awaiter(const next_awaiter&) = delete;
+						next_awaiter& operator=(const next_awaiter&) = delete;
+						~next_awaiter()
+						{
+								if (m_waiting) {
+										m_dispatcher->disconnect(*m_id);
 								}
 						}
-						m_event_queue.clear();
-				}
-				else { // respond to a limited amount of events
-						for (auto& e : m_event_queue) {
-								for (auto& h : m_handler_map[e.signal]) {
-										if (h.has_value()) {
-												std::apply(h.value(), e.args);
-												m_event_queue.pop_front();
-										}
-										++progress;
-										if (progress == limit) {
-												break;
-										}
-								}
+
+						bool await_ready() const noexcept { return false; }
+
+						void await_suspend(std::coroutine_handle<> waiting)
+						{
+								m_waiting = waiting;
+								m_id = m_dispatcher->connect(m_signal, [awaiter = this](HandlerArgTs... args) {
+										// disconnecting destroys this handler, nothing of it may be used afterwards
+										next_awaiter* self = awaiter;
+										self->m_result.emplace(std::forward<HandlerArgTs>(args)...);
+										auto resumed = std::exchange(self->m_waiting, nullptr);
+										self->m_dispatcher->disconnect(*self->m_id);
+										resumed.resume();
+								});
 						}
-				}
-				return progress;
-		}
 
-		template<typename SignalT, typename... HandlerArgTs>
-		void
-				dispatcher<SignalT, HandlerArgTs...>::disconnect(const handler_id_type& handler_id)
-		{
-				m_handler_map[handler_id.signal][handler_id.index] = std::nullopt;
-				m_unused_handler_storage_indices[handler_id.signal].push_back(handler_id.index);
-		}
+						result_type await_resume() { return std::move(*m_result); }
 
-		template<typename SignalT, typename... HandlerArgTs>
-		void
-				dispatcher<SignalT, HandlerArgTs...>::update_events(
-						const tmf::callable<void(typename dispatcher<SignalT, HandlerArgTs...>::event_queue_type&)>& updater)
-		{
-				updater(m_event_queue);
+				private:
+						basic_dispatcher* m_dispatcher;
+						SignalT m_signal;
+						std::optional<handler_id_type> m_id;
+						std::coroutine_handle<> m_waiting;
+						std::optional<result_type> m_result;
+				};
+
+				// co_await next(signal) waits for the next event of signal without a thread, see next_awaiter.
+				// like connect, call it from the responding thread
+				next_awaiter next(const SignalT& signal);
+#endif
+
+		private:
+				// moves events that concurrent producers have pushed onto the event queue, consumer thread only
+				void collect_events();
+
+				// releases or compacts the chains queued by connect and disconnect and refreshes pattern handlers, never while
+				// handlers are running
+				void compact_chains();
+
+				// the chain part of compact_chains, which leaves the pattern matches respond has looked up in place
+				void release_chains();
+
+				// compacts chain if it needs compaction, replaces its disconnected handlers with tombstones otherwise
+				void release_chain(handler_chain_type& chain);
+
+				// handles up to limit events (0 for all pending), as long as proceed() returns true before each one
+				template<typename ProceedT>
+				size_t respond_while(size_t limit, ProceedT&& proceed);
+
+				// appends an event to the queue of its priority level, unless it is coalesced into a pending one or a full queue
+				// turns it away
+				bool enqueue(event_type&& e, size_t level = 0);
+
+				// events in the queues of all priority levels
+				size_t queued_events() const;
+
+				// removes and returns the front event of the highest priority level with events, the queues must not be empty
+				event_type take_next_event();
+
+				// applies the overflow action of a bounded policy to a push onto a full queue, single threaded policies only
+				bool push_overflowing_event(event_type&& e);
+
+				struct coalescing_entry
+				{
+						std::optional<merge_type> merge;
+						// sequence number of the pending event to coalesce into, see m_front_sequence
+						size_t pending = static_cast<size_t>(-1);
+				};
+
+				// the pending event an entry refers to, nullptr once it left the queue
+				event_type* pending_event(const coalescing_entry& entry, const SignalT& signal);
+
+				// removes the front event from the queue of priority 0
+				void pop_front_event();
+
+				timer_id_type schedule_timer(clock_type::time_point due, clock_type::duration period, event_type&& e);
+
+				// pushes the events of due timers, consumer thread only
+				void expire_timers();
+
+				// timers are shared with concurrent producers, otherwise this lock is never taken
+				std::unique_lock<std::mutex> lock_timers() const;
+
+				// hands room in a bounded queue back to concurrent producers
+				void release_capacity(size_t count);
+
+				// builds an event, with arguments allocated from the arena if the policy has one
+				template<typename... FwdHandlerArgTs>
+				event_type make_event(const SignalT& signal, FwdHandlerArgTs&&... args);
+
+				// pushes make(element) for the elements of range like push_event would, see push_events
+				template<typename RangeT, typename MakeT>
+				size_t push_range(RangeT&& range, MakeT&& make);
+
+				// push_event for replay. a bounded queue that blocks when full would wait for room only the responding thread
+				// can make, so the responding thread responds until there is room instead
+				template<typename... FwdHandlerArgTs>
+				bool push_replayed(size_t level, const SignalT& signal, FwdHandlerArgTs&&... args);
+
+				// resets the arena once the queue is empty, so the next batch reuses its memory
+				void recycle_arena();
+
+				event_queue_type make_event_queue();
+
+				// a queue for every priority level above 0, priority 0 events live in m_event_queue
+				using priority_queues_type = std::array<event_queue_type, PolicyT::priority_levels - 1>;
+
+				template<size_t... Levels>
+				priority_queues_type make_priority_queues(std::index_sequence<Levels...>);
+
+				// what policy::instrumented keeps per signal, handlers are indexed by their slot
+				struct signal_record
+				{
+						std::atomic<size_t> pushed{ 0 };
+						std::atomic<size_t> handled{ 0 };
+						latency_histogram queue_latency;
+						std::deque<latency_histogram> handlers;
+				};
+
+				// connects a handler constructed from args to the chain of signal and returns its id. while handlers run the
+				// chain is not touched, the handler joins it once they are done
+				template<typename... ArgTs>
+				handler_id_type connect_handler(const SignalT& signal, ArgTs&&... args);
+
+				// builds the id of a handler that was just connected
+				handler_id_type connected(const SignalT& signal, const typename handler_chain_type::slot_id& slot);
+
+				// a handler of connect_any, connect_range or connect_if. slots are reused, the generation tells them apart
+				struct pattern_subscription
+				{
+						// empty once the handler was disconnected and no handler is running anymore
+						std::optional<handler_type> handler;
+						// set for connect_range
+						std::optional<std::pair<SignalT, SignalT>> range;
+						// set for connect_if
+						std::optional<predicate_type> predicate;
+						size_t generation = 0;
+						// connection order
+						size_t sequence = 0;
+						bool live = false;
+						std::conditional_t<PolicyT::collect_statistics, latency_histogram, std::monostate> run_time{};
+				};
+
+				// a pattern subscription that matched a signal when the match was remembered
+				struct pattern_match
+				{
+						size_t index;
+						size_t generation;
+				};
+				using pattern_matches_type = std::vector<pattern_match>;
+
+				// remembered matches are forgotten at the next chance once there are this many signals
+				static constexpr size_t max_remembered_signals = 4096;
+
+				// what an event is handled by, either may be nullptr
+				struct event_handlers
+				{
+						handler_chain_type* chain = nullptr;
+						const pattern_matches_type* patterns = nullptr;
+				};
+
+				// adds a subscription matching every signal, callers set its range or predicate before it is matched.
+				// signal goes into the id
+				template<typename HandlerT>
+				handler_id_type connect_pattern(const SignalT& signal, HandlerT&& handler);
+
+				bool disconnect_pattern(const handler_id_type& handler_id);
+
+				// the pattern subscriptions signal matches, nullptr if none. key is set to the signal the matches are
+				// remembered under, which stays in place until they are forgotten. consumer thread only
+				const pattern_matches_type* find_patterns(const SignalT& signal, const SignalT** key = nullptr);
+
+				// works out which pattern subscriptions signal matches, in connection order
+				pattern_matches_type match_patterns(const SignalT& signal) const;
+
+				// destroys the handlers disconnected while handlers were running, rebuilds the pattern indices and forgets
+				// remembered matches after pattern handlers changed. never while handlers are running
+				void refresh_patterns();
+
+				// the subscription of match, nullptr if it was disconnected since
+				pattern_subscription* live_pattern(const pattern_match& match);
+
+				// calls the handler of a subscription through call, timing it if the policy is instrumented
+				template<typename CallT>
+				static void run_pattern(pattern_subscription& subscription, CallT&& call);
+
+				// one past the last match that is still connected, 0 if none is
+				size_t live_patterns_end(const pattern_matches_type& matches);
+
+				// calls the pattern handlers of matches up to end, the last one may move arguments out of args
+				void call_patterns(const pattern_matches_type& matches, size_t end, args_storage_type& args);
+
+				// calls the handlers of handlers for e and records statistics if the policy is instrumented
+				void handle_event(const event_handlers& handlers, event_type& e);
+
+				// notes the queue depth after an event was queued, for policy::instrumented
+				void note_queue_depth();
+
+				// stores the size of the queues for events_pending on producer threads, after the responding thread changed them
+				void publish_queue_size();
+
+				// makes the wakeup handle readable after the responding thread queued an event outside of respond, events
+				// queued during respond are taken care of when it returns
+				void notify_queued();
+
+				// calls every connected handler of chain with args, the last one may move arguments out of args unless more
+				// handlers follow (consume_last). record is only used by instrumented policies
+				static void call_chain(handler_chain_type& chain,
+						args_storage_type& args,
+						signal_record* record = nullptr,
+						bool consume_last = true);
+
+				// calls call(), which calls the handler at index of chain, timing it for instrumented policies
+				template<typename CallT>
+				static void run_handler(handler_chain_type& chain, size_t index, signal_record* record, CallT&& call);
+
+				// remembers the chains of the last few signals looked up during one respond call, so bursts of
+				// the same signals cost a few comparisons instead of a hash lookup per event.
+				// chains are never erased from the handler map, so the cached pointers stay valid
+				struct chain_cache
+				{
+						// the handler chain and pattern matches of signal
+						event_handlers find(const SignalT& signal);
+
+						basic_dispatcher& owner;
+						std::array<std::pair<const SignalT*, event_handlers>, 4> entries{};
+						// chains are never erased, a new one may belong to a signal cached without a chain
+						size_t known_chains = owner.m_handler_map.size();
+				};
+
+				// what producers push, together with its priority level if the policy has priorities
+				using staged_event_type =
+						std::conditional_t<(PolicyT::priority_levels > 1), std::pair<size_t, event_type>, event_type>;
+
+				// producers push here when the policy allows concurrent producers, otherwise unused
+				using inbox_type =
+						std::conditional_t<PolicyT::concurrent_producers, mpsc_queue<staged_event_type>, std::monostate>;
+
+				using arena_type =
+						std::conditional_t<(PolicyT::arena_bytes > 0), event_arena<PolicyT::arena_bytes>, std::monostate>;
+
+				static_assert(!(PolicyT::concurrent_producers && PolicyT::arena_bytes > 0),
+						"an event arena can not be shared with concurrent producers");
+				static_assert(PolicyT::capacity == 0 || PolicyT::concurrent_producers
+								|| PolicyT::overflow_action != policy::overflow::block,
+						"overflow::block would wait forever on the only thread that can make room, it needs concurrent producers");
+				static_assert(PolicyT::capacity == 0 || !PolicyT::concurrent_producers
+								|| PolicyT::overflow_action == policy::overflow::reject
+								|| PolicyT::overflow_action == policy::overflow::block,
+						"concurrent producers can only reject or block when the queue is full");
+				static_assert(PolicyT::priority_levels > 0, "there is always at least one priority level");
+				static_assert(PolicyT::capacity == 0 || PolicyT::priority_levels == 1
+								|| PolicyT::overflow_action == policy::overflow::reject
+								|| PolicyT::overflow_action == policy::overflow::block,
+						"a prioritized queue can only reject or block when full");
+
+				// admission of concurrent producers to a bounded queue
+				using gate_type = std::conditional_t<(PolicyT::concurrent_producers && PolicyT::capacity > 0),
+						capacity_gate<PolicyT::capacity>,
+						std::monostate>;
+
+				struct overflow_counters_type
+				{
+						std::atomic<size_t> blocked{ 0 };
+						std::atomic<size_t> rejected{ 0 };
+						std::atomic<size_t> dropped_oldest{ 0 };
+						std::atomic<size_t> dropped_newest{ 0 };
+						std::atomic<size_t> coalesced{ 0 };
+				};
+
+				handler_map_type m_handler_map{};
+				// chains with handlers connected or disconnected while handlers ran, released or compacted once they are done
+				std::vector<handler_chain_type*> m_compaction_queue;
+				// set while respond calls handlers, see respond_while
+				bool m_responding_now = false;
+				wakeup m_wakeup;
+				// how many emit calls are running, disconnect leaves chains in place meanwhile
+				size_t m_emit_depth = 0;
+				// writes queued events to the journal passed to record
+				std::optional<tmf::callable<void(const event_type&, size_t)>> m_recorder;
+				// pattern handlers, a deque keeps a running handler in place while handlers connect others
+				std::deque<pattern_subscription> m_patterns;
+				std::vector<size_t> m_free_patterns;
+				// disconnected while handlers were running, their handlers are destroyed by refresh_patterns
+				std::vector<size_t> m_disconnected_patterns;
+				size_t m_live_patterns = 0;
+				size_t m_pattern_sequence = 0;
+				bool m_patterns_changed = false;
+				// indices of the live subscriptions of connect_any and connect_if, and an index over the ranges
+				std::vector<size_t> m_any_patterns;
+				std::vector<size_t> m_predicate_patterns;
+				std::conditional_t<is_ordered_v<SignalT>, interval_index<SignalT, size_t>, std::monostate> m_range_index{};
+				// which pattern subscriptions signals matched so far
+				std::unordered_map<SignalT, pattern_matches_type> m_pattern_matches;
+				std::conditional_t<PolicyT::collect_statistics, std::unordered_map<SignalT, signal_record>, std::monostate> m_records{};
+				std::conditional_t<PolicyT::collect_statistics, size_t, std::monostate> m_queue_high_water{};
+				arena_type m_arena{};
+				event_queue_type m_event_queue = make_event_queue();
+				// the batch respond is working through, handlers push onto m_event_queue meanwhile
+				event_queue_type m_responding = make_event_queue();
+				priority_queues_type m_priority_queues = make_priority_queues(
+						std::make_index_sequence<PolicyT::priority_levels - 1>{});
+				// queued_events() as of the last change, for events_pending on producer threads
+				std::conditional_t<PolicyT::concurrent_producers, std::atomic<size_t>, std::monostate> m_queue_size{};
+				// sequence number of the front event, every event gets the next number when it is queued
+				size_t m_front_sequence = 0;
+				std::unordered_map<SignalT, coalescing_entry> m_coalescing;
+				timer_wheel<event_type> m_timers{};
+				mutable std::mutex m_timer_lock;
+				inbox_type m_inbox{};
+				gate_type m_gate{};
+				std::conditional_t<(PolicyT::capacity > 0), overflow_counters_type, std::monostate> m_overflow{};
+		};
+
+		// the static interface, every function forwards to basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::default_instance()
+		// so all users of the same event signature share one handler map and event queue
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		struct global_dispatcher
+		{
+				// the dispatcher type which can be instantiated, to get a handler map and event queue of your own
+				using instance_type = basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>;
+
+				using policy_type = typename instance_type::policy_type;
+				using signal_type = typename instance_type::signal_type;
+				using handler_type = typename instance_type::handler_type;
+				using args_storage_type = typename instance_type::args_storage_type;
+				using handler_chain_type = typename instance_type::handler_chain_type;
+				using handler_id_type = typename instance_type::handler_id_type;
+				using handler_map_type = typename instance_type::handler_map_type;
+				using event_type = typename instance_type::event_type;
+				using event_queue_type = typename instance_type::event_queue_type;
+				using clock_type = typename instance_type::clock_type;
+				using timer_id_type = typename instance_type::timer_id_type;
+				using statistics_type = typename instance_type::statistics_type;
+
+				// the shared instance behind this interface
+				static instance_type& instance();
+
+				// see basic_dispatcher
+				template<typename HandlerT>
+				static handler_id_type connect(const SignalT& signal, HandlerT&& handler);
+
+				template<typename HandlerT, typename... BoundArgTs>
+				static handler_id_type connect_bind(const SignalT& signal, HandlerT&& handler, BoundArgTs&&... bound_args);
+
+				template<typename ClassT, typename MemPtrT>
+				static handler_id_type connect_member(const SignalT& signal, ClassT&& object, MemPtrT member);
+
+				template<typename ClassT, typename MemPtrT, typename... BoundArgTs>
+				static handler_id_type connect_bind_member(const SignalT& signal,
+						ClassT&& object,
+						MemPtrT member,
+						BoundArgTs&&... bound_args);
+
+				template<typename HandlerT>
+				static handler_id_type connect_any(HandlerT&& handler);
+
+				template<typename HandlerT>
+				static handler_id_type connect_range(const SignalT& first, const SignalT& last, HandlerT&& handler);
+
+				template<typename HandlerT>
+				static handler_id_type connect_if(typename instance_type::predicate_type predicate, HandlerT&& handler);
+
+				template<typename... FwdHandlerArgTs>
+				static bool push_event(const SignalT& signal, FwdHandlerArgTs&&... args);
+
+				template<typename... FwdHandlerArgTs>
+				static bool push_event(priority prio, const SignalT& signal, FwdHandlerArgTs&&... args);
+
+				template<typename RangeT>
+				static size_t push_events(const SignalT& signal, RangeT&& range);
+
+				template<typename RangeT>
+				static size_t push_events(RangeT&& range);
+
+				template<typename... FwdHandlerArgTs>
+				static void emit(const SignalT& signal, FwdHandlerArgTs&&... args);
+
+				template<typename... FwdHandlerArgTs>
+				static typename instance_type::timer_id_type push_event_at(typename instance_type::clock_type::time_point due,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args);
+
+				template<typename... FwdHandlerArgTs>
+				static typename instance_type::timer_id_type push_event_after(typename instance_type::clock_type::duration delay,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args);
+
+				template<typename... FwdHandlerArgTs>
+				static typename instance_type::timer_id_type push_event_every(typename instance_type::clock_type::duration period,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args);
+
+				static bool cancel_timer(const typename instance_type::timer_id_type& timer_id);
+
+				static size_t timers_pending();
+
+				static size_t events_pending();
+
+				static overflow_stats overflow_counters();
+
+				static typename instance_type::statistics_type statistics();
+
+				static void reset_statistics();
+
+				static void coalesce(const SignalT& signal);
+
+				static void coalesce(const SignalT& signal, typename instance_type::merge_type merge);
+
+				static void stop_coalescing(const SignalT& signal);
+
+				static size_t respond(size_t limit = 0);
+
+				static size_t respond_until(typename instance_type::clock_type::time_point deadline);
+
+				static size_t respond_for(typename instance_type::clock_type::duration budget);
+
+				static size_t wait_and_respond(typename instance_type::clock_type::duration timeout);
+
+				static void wake();
+
+				static void clear_wake();
+
+				static int wakeup_handle();
+
+				static typename instance_type::clock_type::time_point next_timer_due();
+
+				static size_t respond(thread_pool& pool, ordering order = ordering::per_signal_fifo, size_t limit = 0);
+
+				static bool disconnect(const handler_id_type& handler_id);
+
+				static void update_events(const tmf::callable<void(event_queue_type&)>& updater);
+
+				static void record(journal_writer& journal);
+
+				static void stop_recording();
+
+				static replay_stats replay(journal_reader& journal, replay_timing timing = replay_timing::as_fast_as_possible);
+
+#ifdef HANDLEBARS_COROUTINES
+				static typename instance_type::next_awaiter next(const SignalT& signal);
+#endif
+
+		private:
+				global_dispatcher() {}
+		};
+
+		// single threaded dispatcher, the default
+		template<typename SignalT, typename... HandlerArgTs>
+		using dispatcher = global_dispatcher<policy::defaults, SignalT, HandlerArgTs...>;
+
+		// dispatcher whose push_event may be called from many threads while one thread calls respond
+		template<typename SignalT, typename... HandlerArgTs>
+		using concurrent_dispatcher = global_dispatcher<policy::concurrent<>, SignalT, HandlerArgTs...>;
+
+		// dispatcher for signals named by strings, which are interned so events carry and compare integers
+		template<typename... HandlerArgTs>
+		using symbol_dispatcher = global_dispatcher<policy::defaults, symbol, HandlerArgTs...>;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////Implementation//////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace handlebars {
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>&
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::default_instance()
+		{
+				static basic_dispatcher instance;
+				return instance;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename HandlerT>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect(const SignalT& signal, HandlerT&& handler)
+		{
+				return connect_handler(signal, std::forward<HandlerT>(handler));
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename HandlerT, typename... BoundArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_bind(const SignalT& signal,
+						HandlerT&& handler,
+						BoundArgTs&&... bound_args)
+		{
+				return connect_handler(signal,
+						[&, bound_tuple = std::forward_as_tuple(std::forward<BoundArgTs>(bound_args)...)](HandlerArgTs&&... args) {
+						std::apply(handler, std::tuple_cat(bound_tuple, std::make_tuple(std::forward<HandlerArgTs>(args)...)));
+				});
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename ClassT, typename MemPtrT>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_member(const SignalT& signal, ClassT&& object, MemPtrT member)
+		{
+				return connect_handler(signal, std::forward<ClassT>(object), member);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename ClassT, typename MemPtrT, typename... BoundArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_bind_member(const SignalT& signal,
+						ClassT&& object,
+						MemPtrT member,
+						BoundArgTs&&... bound_args)
+		{
+				return connect_handler(signal,
+						[=, bound_tuple = std::forward_as_tuple(std::forward<BoundArgTs>(bound_args)...)](HandlerArgTs&&... args) {
+						std::apply(function(std::forward<ClassT>(object), member),
+								std::tuple_cat(bound_tuple, std::forward_as_tuple(std::forward<HandlerArgTs>(args)...)));
+				});
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename HandlerT>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_any(HandlerT&& handler)
+		{
+				return connect_pattern(SignalT{}, std::forward<HandlerT>(handler));
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename HandlerT>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_range(const SignalT& first,
+						const SignalT& last,
+						HandlerT&& handler)
+		{
+				static_assert(is_ordered_v<SignalT>, "connect_range needs signals that can be compared with <");
+				auto id = connect_pattern(first, std::forward<HandlerT>(handler));
+				m_patterns[id.index].range.emplace(first, last);
+				return id;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename HandlerT>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_if(predicate_type predicate, HandlerT&& handler)
+		{
+				auto id = connect_pattern(SignalT{}, std::forward<HandlerT>(handler));
+				m_patterns[id.index].predicate.emplace(std::move(predicate));
+				return id;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		bool
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event(const SignalT& signal, FwdHandlerArgTs&&... args)
+		{
+				return push_event(priority{}, signal, std::forward<FwdHandlerArgTs>(args)...);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		bool
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event(priority prio,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args)
+		{
+				size_t level = std::min(prio.level, PolicyT::priority_levels - 1);
+				if constexpr (PolicyT::concurrent_producers) {
+						if constexpr (PolicyT::capacity > 0 && PolicyT::overflow_action == policy::overflow::block) {
+								if (!m_gate.acquire()) {
+										m_overflow.blocked.fetch_add(1, std::memory_order_relaxed);
+								}
+						}
+						else if constexpr (PolicyT::capacity > 0) {
+								if (!m_gate.try_acquire()) {
+										m_overflow.rejected.fetch_add(1, std::memory_order_relaxed);
+										return false;
+								}
+						}
+						if constexpr (PolicyT::priority_levels > 1) {
+								m_inbox.push(level, make_event(signal, std::forward<FwdHandlerArgTs>(args)...));
+						}
+						else {
+								m_inbox.push(make_event(signal, std::forward<FwdHandlerArgTs>(args)...));
+						}
+						m_wakeup.notify();
+				}
+				else {
+						return enqueue(make_event(signal, std::forward<FwdHandlerArgTs>(args)...), level);
+				}
+				return true;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename RangeT>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_events(const SignalT& signal, RangeT&& range)
+		{
+				static_assert(sizeof...(HandlerArgTs) > 0, "push_events needs an argument per element");
+				return push_range(std::forward<RangeT>(range), [&](auto&& element) {
+						if constexpr (sizeof...(HandlerArgTs) == 1) {
+								return make_event(signal, std::forward<decltype(element)>(element));
+						}
+						else {
+								return std::apply(
+										[&](auto&&... args) { return make_event(signal, std::forward<decltype(args)>(args)...); },
+										std::forward<decltype(element)>(element));
+						}
+				});
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename RangeT>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_events(RangeT&& range)
+		{
+				return push_range(std::forward<RangeT>(range), [&](auto&& element) {
+						return std::apply(
+								[&](auto&& signal, auto&&... args) { return make_event(signal, std::forward<decltype(args)>(args)...); },
+								std::forward<decltype(element)>(element));
+				});
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename RangeT, typename MakeT>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_range(RangeT&& range, MakeT&& make)
+		{
+				using std::begin;
+				using std::end;
+				auto first = begin(range);
+				auto last = end(range);
+				auto element = [&]() -> decltype(auto) {
+						if constexpr (std::is_lvalue_reference_v<RangeT>) {
+								return *first;
+						}
+						else {
+								return std::move(*first);
+						}
+				};
+				size_t pushed = 0;
+				if constexpr (PolicyT::concurrent_producers) {
+						typename inbox_type::batch staged;
+						auto stage = [&](event_type&& e) {
+								if constexpr (PolicyT::priority_levels > 1) {
+										staged.push(size_t(0), std::move(e));
+								}
+								else {
+										staged.push(std::move(e));
+								}
+						};
+						if constexpr (PolicyT::capacity > 0 && PolicyT::overflow_action == policy::overflow::block) {
+								for (; first != last; ++first, ++pushed) {
+										if (!m_gate.try_acquire()) {
+												// respond can only make room by taking events it can see
+												m_inbox.push_batch(staged);
+												m_wakeup.notify();
+												if (!m_gate.acquire()) {
+														m_overflow.blocked.fetch_add(1, std::memory_order_relaxed);
+												}
+										}
+										stage(make(element()));
+								}
+						}
+						else {
+								auto count = static_cast<size_t>(std::distance(first, last));
+								if constexpr (PolicyT::capacity > 0) {
+										size_t room = m_gate.try_acquire(count);
+										if (room < count) {
+												m_overflow.rejected.fetch_add(count - room, std::memory_order_relaxed);
+										}
+										count = room;
+								}
+								for (; pushed < count; ++first, ++pushed) {
+										stage(make(element()));
+								}
+						}
+						m_inbox.push_batch(staged);
+						if (pushed > 0) {
+								m_wakeup.notify();
+						}
+				}
+				else {
+						for (; first != last; ++first) {
+								if (enqueue(make(element()))) {
+										++pushed;
+								}
+						}
+				}
+				return pushed;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::emit(const SignalT& signal, FwdHandlerArgTs&&... args)
+		{
+				static_assert(sizeof...(FwdHandlerArgTs) == sizeof...(HandlerArgTs), "emit takes every argument of the event signature");
+				auto found = m_handler_map.find(signal);
+				handler_chain_type* chain = (found != m_handler_map.end() && found->second.live_end() > 0) ? &found->second : nullptr;
+				auto patterns = find_patterns(signal);
+				size_t patterns_end = (patterns != nullptr) ? live_patterns_end(*patterns) : 0;
+				if (chain == nullptr && patterns_end == 0) {
+						return;
+				}
+				signal_record* record = nullptr;
+				if constexpr (PolicyT::collect_statistics) {
+						auto found_record = m_records.find(signal);
+						record = (found_record != m_records.end()) ? &found_record->second : nullptr;
+				}
+				++m_emit_depth;
+				if (chain != nullptr) {
+						size_t last = chain->live_end();
+						for (size_t index = 0; index + 1 < last; ++index) {
+								if (!chain->skipped(index)) {
+										run_handler(*chain, index, record, [&] { (*chain)[index](pass_on<HandlerArgTs, false, FwdHandlerArgTs>(args)...); });
+								}
+						}
+						if (!chain->skipped(last - 1)) {
+								run_handler(*chain, last - 1, record, [&] {
+										if (patterns_end == 0) {
+												(*chain)[last - 1](pass_on<HandlerArgTs, true, FwdHandlerArgTs>(args)...);
+										}
+										else {
+												(*chain)[last - 1](pass_on<HandlerArgTs, false, FwdHandlerArgTs>(args)...);
+										}
+								});
+						}
+				}
+				for (size_t index = 0; index < patterns_end; ++index) {
+						if (auto subscription = live_pattern((*patterns)[index])) {
+								run_pattern(*subscription, [&](handler_type& handler) {
+										if (index + 1 < patterns_end) {
+												handler(pass_on<HandlerArgTs, false, FwdHandlerArgTs>(args)...);
+										}
+										else {
+												handler(pass_on<HandlerArgTs, true, FwdHandlerArgTs>(args)...);
+										}
+								});
+						}
+				}
+				// handlers disconnected meanwhile were left in place while they were being called
+				if (--m_emit_depth == 0 && !m_responding_now) {
+						compact_chains();
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		bool
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::enqueue(event_type&& e, size_t level)
+		{
+				if (m_recorder.has_value()) {
+						m_recorder.value()(e, level);
+				}
+				if constexpr (PolicyT::collect_statistics) {
+						m_records[e.signal].pushed.fetch_add(1, std::memory_order_relaxed);
+				}
+				if constexpr (PolicyT::priority_levels > 1) {
+						if (level > 0) {
+								if constexpr (PolicyT::capacity > 0 && !PolicyT::concurrent_producers) {
+										if (queued_events() >= PolicyT::capacity) {
+												++m_overflow.rejected;
+												return false;
+										}
+								}
+								m_priority_queues[level - 1].push_back(std::move(e));
+								note_queue_depth();
+								publish_queue_size();
+								notify_queued();
+								return true;
+						}
+				}
+
+				coalescing_entry* coalescing = nullptr;
+				if (!m_coalescing.empty()) {
+						auto found = m_coalescing.find(e.signal);
+						if (found != m_coalescing.end()) {
+								coalescing = &found->second;
+								if (auto pending = pending_event(*coalescing, e.signal)) {
+										if (coalescing->merge.has_value()) {
+												coalescing->merge.value()(pending->args, e.args);
+										}
+										else {
+												pending->args = std::move(e.args);
+										}
+										return true;
+								}
+						}
+				}
+
+				if constexpr (PolicyT::capacity > 0 && !PolicyT::concurrent_producers) {
+						if (queued_events() >= PolicyT::capacity) {
+								if (!push_overflowing_event(std::move(e))) {
+										return false;
+								}
+						}
+						else {
+								m_event_queue.push_back(std::move(e));
+						}
+				}
+				else {
+						m_event_queue.push_back(std::move(e));
+				}
+				if (coalescing != nullptr) {
+						coalescing->pending = m_front_sequence + m_event_queue.size() - 1;
+				}
+				note_queue_depth();
+				publish_queue_size();
+				notify_queued();
+				return true;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::event_type*
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::pending_event(const coalescing_entry& entry,
+						const SignalT& signal)
+		{
+				if (entry.pending < m_front_sequence || entry.pending - m_front_sequence >= m_event_queue.size()) {
+						return nullptr;
+				}
+				auto& e = m_event_queue[entry.pending - m_front_sequence];
+				// the queue may have been rearranged by update_events or drop_newest since
+				return (e.signal == signal) ? &e : nullptr;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::timer_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event_at(clock_type::time_point due,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args)
+		{
+				// timers outlive arena resets, so their arguments are never allocated from the arena
+				return schedule_timer(due,
+						clock_type::duration::zero(),
+						event_type{ {}, signal, args_storage_type{ std::forward<FwdHandlerArgTs>(args)... } });
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::timer_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event_after(clock_type::duration delay,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args)
+		{
+				return push_event_at(clock_type::now() + delay, signal, std::forward<FwdHandlerArgTs>(args)...);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::timer_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event_every(clock_type::duration period,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args)
+		{
+				static_assert(std::is_copy_constructible_v<event_type>, "periodic events are copied, their arguments must be copyable");
+				return schedule_timer(clock_type::now() + period,
+						period,
+						event_type{ {}, signal, args_storage_type{ std::forward<FwdHandlerArgTs>(args)... } });
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		bool
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::cancel_timer(const timer_id_type& timer_id)
+		{
+				auto lock = lock_timers();
+				return m_timers.cancel(timer_id);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::timers_pending() const
+		{
+				auto lock = lock_timers();
+				return m_timers.size();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::timer_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::schedule_timer(clock_type::time_point due,
+						clock_type::duration period,
+						event_type&& e)
+		{
+				timer_id_type id;
+				{
+						auto lock = lock_timers();
+						id = m_timers.schedule(due, std::move(e), period);
+				}
+				// the new timer may be due before wait_and_respond meant to wake up
+				m_wakeup.notify();
+				return id;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::expire_timers()
+		{
+				auto lock = lock_timers();
+				if (m_timers.size() == 0) {
+						return;
+				}
+				m_timers.advance(clock_type::now(), [this](event_type&& e) {
+						if constexpr (PolicyT::collect_statistics) {
+								e.pushed_at = clock_type::now();
+						}
+						if constexpr (PolicyT::concurrent_producers && PolicyT::capacity > 0) {
+								// due events are let in whether the queue is full or not, like events put back by update_events
+								m_gate.force_acquire(1);
+								size_t before = queued_events();
+								enqueue(std::move(e));
+								if (queued_events() == before) {
+										release_capacity(1);
+								}
+						}
+						else {
+								enqueue(std::move(e));
+						}
+				});
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		std::unique_lock<std::mutex>
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::lock_timers() const
+		{
+				if constexpr (PolicyT::concurrent_producers) {
+						return std::unique_lock<std::mutex>{ m_timer_lock };
+				}
+				else {
+						return {};
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::queued_events() const
+		{
+				size_t count = m_event_queue.size() + m_responding.size();
+				for (auto& queue : m_priority_queues) {
+						count += queue.size();
+				}
+				return count;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::event_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::take_next_event()
+		{
+				for (auto queue = m_priority_queues.rbegin(); queue != m_priority_queues.rend(); ++queue) {
+						if (!queue->empty()) {
+								event_type e = std::move(queue->front());
+								queue->pop_front();
+								publish_queue_size();
+								return e;
+						}
+				}
+				event_type e = std::move(m_event_queue.front());
+				pop_front_event();
+				return e;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::pop_front_event()
+		{
+				m_event_queue.pop_front();
+				++m_front_sequence;
+				publish_queue_size();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::coalesce(const SignalT& signal)
+		{
+				m_coalescing[signal].merge.reset();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::coalesce(const SignalT& signal, merge_type merge)
+		{
+				m_coalescing[signal].merge.emplace(std::move(merge));
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::stop_coalescing(const SignalT& signal)
+		{
+				m_coalescing.erase(signal);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		bool
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_overflowing_event(event_type&& incoming)
+		{
+				constexpr auto action = PolicyT::overflow_action;
+				if constexpr (action == policy::overflow::drop_oldest || action == policy::overflow::drop_newest) {
+						if (m_event_queue.empty()) {
+								// every pending event is being handled by respond right now, none can be dropped
+								++m_overflow.rejected;
+								return false;
+						}
+				}
+				if constexpr (action == policy::overflow::drop_oldest) {
+						pop_front_event();
+						++m_overflow.dropped_oldest;
+				}
+				else if constexpr (action == policy::overflow::drop_newest) {
+						m_event_queue.pop_back();
+						++m_overflow.dropped_newest;
+				}
+				else if constexpr (action == policy::overflow::coalesce) {
+						for (auto e = m_event_queue.rbegin(); e != m_event_queue.rend(); ++e) {
+								if (e->signal == incoming.signal) {
+										e->args = std::move(incoming.args);
+										++m_overflow.coalesced;
+										return true;
+								}
+						}
+						++m_overflow.rejected;
+						return false;
+				}
+				else {
+						++m_overflow.rejected;
+						return false;
+				}
+				m_event_queue.push_back(std::move(incoming));
+				return true;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		overflow_stats
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::overflow_counters() const
+		{
+				if constexpr (PolicyT::capacity > 0) {
+						return { m_overflow.blocked.load(std::memory_order_relaxed),
+								m_overflow.rejected.load(std::memory_order_relaxed),
+								m_overflow.dropped_oldest.load(std::memory_order_relaxed),
+								m_overflow.dropped_newest.load(std::memory_order_relaxed),
+								m_overflow.coalesced.load(std::memory_order_relaxed) };
+				}
+				else {
+						return {};
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::release_capacity(size_t count)
+		{
+				if constexpr (PolicyT::concurrent_producers && PolicyT::capacity > 0) {
+						m_gate.release(count);
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::events_pending() const
+		{
+				if constexpr (PolicyT::concurrent_producers) {
+						// the queues belong to the responding thread, which publishes their size
+						return m_queue_size.load(std::memory_order_relaxed) + m_inbox.size();
+				}
+				else {
+						return queued_events();
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::respond(size_t limit)
+		{
+				return respond_while(limit, [] { return true; });
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::respond_until(clock_type::time_point deadline)
+		{
+				return respond_while(0, [deadline] { return clock_type::now() < deadline; });
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::respond_for(clock_type::duration budget)
+		{
+				return respond_until(clock_type::now() + budget);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::wait_and_respond(clock_type::duration timeout)
+		{
+				if (m_responding_now) {
+						// called by a handler, the outer respond has the events and waiting would only spin
+						return 0;
+				}
+				auto deadline = clock_type::now() + timeout;
+				while (true) {
+						m_wakeup.wait_until(std::min(deadline, next_timer_due()), [this] { return events_pending() > 0; });
+						// a push may not be complete yet, or the wakeup was for a timer that is not quite due
+						size_t handled = respond();
+						// asked every time, an interrupt left set would cut the next wait short
+						bool woken = m_wakeup.interrupted();
+						if (handled > 0 || woken || clock_type::now() >= deadline) {
+								return handled;
+						}
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::wake()
+		{
+				m_wakeup.interrupt();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::clear_wake()
+		{
+				m_wakeup.interrupted();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		int
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::wakeup_handle()
+		{
+				int handle = m_wakeup.event_fd();
+				if (events_pending() > 0) {
+						m_wakeup.notify();
+				}
+				return handle;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::clock_type::time_point
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::next_timer_due() const
+		{
+				auto lock = lock_timers();
+				return m_timers.next_due();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename ProceedT>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::respond_while(size_t limit, ProceedT&& proceed)
+		{
+				if (m_responding_now) {
+						// called by a handler of this dispatcher, the outer call is still working through its batch
+						return 0;
+				}
+				m_responding_now = true;
+				m_wakeup.rearm();
+				collect_events();
+				expire_timers();
+				compact_chains();
+				chain_cache chains{ *this };
+				size_t progress = 0;
+				if constexpr (PolicyT::priority_levels > 1) {
+						// events pushed by handlers during this call are left for the next one
+						size_t queued = queued_events();
+						size_t count = (limit == 0) ? queued : std::min(limit, queued);
+						for (; progress < count && proceed(); ++progress) {
+								// a handler may push an event of higher priority, so the next event is picked one at a time
+								event_type e = take_next_event();
+								handle_event(chains.find(e.signal), e);
+								if (!m_compaction_queue.empty()) {
+										// handlers connected by this event's handlers are called for the next one
+										release_chains();
+								}
+						}
+				}
+				else {
+						// the pending events become the batch, events pushed by handlers go onto the emptied buffer and are left
+						// for the next call. overflow actions and coalescing only touch that buffer, so batch events stay put
+						// while their handlers run
+						m_front_sequence += m_event_queue.size();
+						std::swap(m_event_queue, m_responding);
+						size_t count = (limit == 0) ? m_responding.size() : std::min(limit, m_responding.size());
+						for (; progress < count && proceed(); ++progress) {
+								auto& e = m_responding.front();
+								handle_event(chains.find(e.signal), e);
+								m_responding.pop_front();
+								publish_queue_size();
+								if (!m_compaction_queue.empty()) {
+										release_chains();
+								}
+						}
+						if (!m_responding.empty()) {
+								// the rest of the batch goes back in front of the events pushed meanwhile
+								m_front_sequence -= m_responding.size();
+								for (auto& e : m_event_queue) {
+										m_responding.push_back(std::move(e));
+								}
+								m_event_queue.clear();
+								std::swap(m_event_queue, m_responding);
+						}
+				}
+				release_capacity(progress);
+				recycle_arena();
+				if (queued_events() > 0) {
+						// left over for the next call, a poll loop has to come back for them
+						m_wakeup.notify();
+				}
+				// handlers disconnected during the call are destroyed now that none is running
+				compact_chains();
+				m_responding_now = false;
+				return progress;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::respond(thread_pool& pool, ordering order, size_t limit)
+		{
+				if (order == ordering::strict_fifo) {
+						return respond(limit);
+				}
+				if (m_responding_now) {
+						return 0;
+				}
+				m_responding_now = true;
+				m_wakeup.rearm();
+				collect_events();
+				expire_timers();
+				compact_chains();
+				size_t queued = queued_events();
+				size_t count = (limit == 0) ? queued : std::min(limit, queued);
+				std::vector<event_type> batch;
+				batch.reserve(count);
+				for (size_t i = 0; i < count; ++i) {
+						batch.emplace_back(take_next_event());
+				}
+				release_capacity(count);
+
+				// handler chains are looked up here, workers never touch the handler map
+				chain_cache chains{ *this };
+
+				if (order == ordering::unordered) {
+						std::vector<event_handlers> handlers;
+						handlers.reserve(count);
+						for (auto& e : batch) {
+								handlers.push_back(chains.find(e.signal));
+						}
+						pool.run(count, [&](size_t index) { handle_event(handlers[index], batch[index]); });
+				}
+				else { // one task per signal, which handles that signals events in order
+						struct signal_group
+						{
+								event_handlers handlers;
+								std::vector<size_t> events;
+						};
+						std::vector<signal_group> groups;
+						std::unordered_map<SignalT, size_t> group_indices;
+						for (size_t index = 0; index < count; ++index) {
+								auto [found, inserted] = group_indices.try_emplace(batch[index].signal, groups.size());
+								if (inserted) {
+										groups.push_back({ chains.find(batch[index].signal), {} });
+								}
+								groups[found->second].events.push_back(index);
+						}
+						pool.run(groups.size(), [&](size_t group) {
+								for (auto index : groups[group].events) {
+										handle_event(groups[group].handlers, batch[index]);
+								}
+						});
+				}
+				batch.clear();
+				recycle_arena();
+				if (queued_events() > 0) {
+						// left over for the next call, a poll loop has to come back for them
+						m_wakeup.notify();
+				}
+				// handlers disconnected during the call are destroyed now that none is running
+				compact_chains();
+				m_responding_now = false;
+				return count;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		bool
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::disconnect(const handler_id_type& handler_id)
+		{
+				if (handler_id.pattern) {
+						return disconnect_pattern(handler_id);
+				}
+				auto found = m_handler_map.find(handler_id.signal);
+				if (found == m_handler_map.end()) {
+						return false;
+				}
+				auto& chain = found->second;
+				if (!chain.disconnect({ handler_id.index, handler_id.generation })) {
+						return false;
+				}
+				if (!m_responding_now && m_emit_depth == 0) {
+						release_chain(chain);
+				}
+				else if (!chain.compaction_queued) {
+						// a handler disconnected, it may be the one running. it is destroyed once handlers are done
+						chain.compaction_queued = true;
+						m_compaction_queue.push_back(&chain);
+				}
+				return true;
+		}
+
+#ifdef HANDLEBARS_COROUTINES
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::next_awaiter
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::next(const SignalT& signal)
+		{
+				return next_awaiter{ *this, signal };
+		}
+#endif
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::compact_chains()
+		{
+				release_chains();
+				refresh_patterns();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::release_chains()
+		{
+				for (auto chain : m_compaction_queue) {
+						release_chain(*chain);
+						chain->compaction_queued = false;
+				}
+				m_compaction_queue.clear();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::release_chain(handler_chain_type& chain)
+		{
+				if (chain.needs_compaction()) {
+						chain.compact();
+				}
+				else {
+						// the tombstone releases whatever the handler held, and is called like any other handler until compaction
+						chain.release([] { return handler_type{ [](HandlerArgTs...) {} }; });
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::update_events(
+						const tmf::callable<void(typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::event_queue_type&)>& updater)
+		{
+				collect_events();
+				size_t before = m_event_queue.size();
+				updater(m_event_queue);
+				// the updater may have moved events anywhere, pending events are no longer coalesced into
+				for (auto& [signal, entry] : m_coalescing) {
+						entry.pending = static_cast<size_t>(-1);
+				}
+				publish_queue_size();
+				if constexpr (PolicyT::concurrent_producers && PolicyT::capacity > 0) {
+						if (m_event_queue.size() < before) {
+								m_gate.release(before - m_event_queue.size());
+						}
+						else {
+								m_gate.force_acquire(m_event_queue.size() - before);
+						}
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::record(journal_writer& journal)
+		{
+				m_recorder.emplace([&journal](const event_type& e, size_t level) {
+						journal.begin_record(level);
+						journal_codec<SignalT>::write(journal, e.signal);
+						std::apply(
+								[&](const auto&... stored) {
+										(journal_codec<std::decay_t<HandlerArgTs>>::write(journal, peek(stored)), ...);
+								},
+								e.args);
+						journal.end_record();
+				});
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::stop_recording()
+		{
+				m_recorder.reset();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		replay_stats
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::replay(journal_reader& journal, replay_timing timing)
+		{
+				struct replayed_event
+				{
+						SignalT signal;
+						std::tuple<std::decay_t<HandlerArgTs>...> args;
+				};
+				// events refer to the decoded values until they are handled, a deque keeps them in place.
+				// batches fit into a bounded queue, so it rarely fills up while replaying
+				constexpr size_t batch_size = (PolicyT::capacity > 0 && PolicyT::capacity < 1024) ? PolicyT::capacity : 1024;
+				std::deque<replayed_event> batch;
+				replay_stats stats;
+				auto started = clock_type::now();
+				std::optional<std::chrono::nanoseconds> first_timestamp;
+				while (journal.next()) {
+						if (timing == replay_timing::original) {
+								if (!first_timestamp) {
+										first_timestamp = journal.timestamp();
+								}
+								std::this_thread::sleep_until(started + (journal.timestamp() - *first_timestamp));
+						}
+						size_t level = journal.level();
+						// braced initialization decodes the arguments in order
+						auto& e = batch.emplace_back(replayed_event{ journal_codec<SignalT>::read(journal),
+								std::tuple<std::decay_t<HandlerArgTs>...>{ journal_codec<std::decay_t<HandlerArgTs>>::read(journal)... } });
+						bool pushed = std::apply(
+								[&](auto&... values) { return push_replayed(level, e.signal, replayed<HandlerArgTs>(values)...); }, e.args);
+						// a bounded queue may turn events away
+						stats.events += pushed ? 1 : 0;
+						if (timing == replay_timing::original || batch.size() == batch_size) {
+								respond();
+								batch.clear();
+						}
+				}
+				respond();
+				stats.elapsed = clock_type::now() - started;
+				return stats;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		bool
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_replayed(size_t level,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args)
+		{
+				if constexpr (PolicyT::concurrent_producers && PolicyT::capacity > 0
+											&& PolicyT::overflow_action == policy::overflow::block) {
+						if (!m_gate.try_acquire()) {
+								m_overflow.blocked.fetch_add(1, std::memory_order_relaxed);
+								// events queued before replay or by producers meanwhile fill the queue, handling them makes room
+								do {
+										respond();
+								} while (!m_gate.try_acquire());
+						}
+						if constexpr (PolicyT::priority_levels > 1) {
+								m_inbox.push(std::min(level, PolicyT::priority_levels - 1),
+										make_event(signal, std::forward<FwdHandlerArgTs>(args)...));
+						}
+						else {
+								m_inbox.push(make_event(signal, std::forward<FwdHandlerArgTs>(args)...));
+						}
+						m_wakeup.notify();
+						return true;
+				}
+				else {
+						return push_event(priority{ level }, signal, std::forward<FwdHandlerArgTs>(args)...);
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::collect_events()
+		{
+				if constexpr (PolicyT::concurrent_producers) {
+						size_t merged = 0;
+						m_inbox.drain([&](staged_event_type&& staged) {
+								size_t before = queued_events();
+								if constexpr (PolicyT::priority_levels > 1) {
+										enqueue(std::move(staged.second), staged.first);
+								}
+								else {
+										enqueue(std::move(staged));
+								}
+								merged += (queued_events() == before) ? 1 : 0;
+						});
+						// coalesced events hand their room back right away
+						release_capacity(merged);
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::event_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::make_event(const SignalT& signal, FwdHandlerArgTs&&... args)
+		{
+				if constexpr (PolicyT::arena_bytes > 0) {
+						// uses-allocator construction, only arguments which take an allocator end up using it
+						return event_type{ push_stamp<PolicyT::collect_statistics>::now(),
+								signal,
+								args_storage_type{ std::allocator_arg,
+										std::pmr::polymorphic_allocator<std::byte>{ m_arena.resource() },
+										std::forward<FwdHandlerArgTs>(args)... } };
+				}
+				else {
+						return event_type{ push_stamp<PolicyT::collect_statistics>::now(),
+								signal,
+								args_storage_type{ std::forward<FwdHandlerArgTs>(args)... } };
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::recycle_arena()
+		{
+				if constexpr (PolicyT::arena_bytes > 0) {
+						if (queued_events() == 0) {
+								// the queues keep their own blocks in the arena, so they are destroyed before and rebuilt after the reset
+								m_event_queue.~event_queue_type();
+								m_responding.~event_queue_type();
+								for (auto& queue : m_priority_queues) {
+										queue.~event_queue_type();
+								}
+								m_arena.release();
+								new (&m_event_queue) event_queue_type(make_event_queue());
+								new (&m_responding) event_queue_type(make_event_queue());
+								for (auto& queue : m_priority_queues) {
+										new (&queue) event_queue_type(make_event_queue());
+								}
+						}
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::event_queue_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::make_event_queue()
+		{
+				if constexpr (PolicyT::arena_bytes > 0) {
+						return event_queue_type{ typename event_queue_type::allocator_type{ m_arena.resource() } };
+				}
+				else {
+						return event_queue_type{};
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<size_t... Levels>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::priority_queues_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::make_priority_queues(std::index_sequence<Levels...>)
+		{
+				return { { ((void)Levels, make_event_queue())... } };
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::call_chain(handler_chain_type& chain,
+						args_storage_type& args,
+						[[maybe_unused]] signal_record* record,
+						bool consume_last)
+		{
+				size_t last = chain.live_end();
+				if (last == 0) {
+						return;
+				}
+				// tombstones are called like any handler. handlers stay in place while handlers connect or disconnect others, or
+				// themselves: handlers connected meanwhile wait for the next event, disconnected ones are skipped
+				for (size_t index = 0; index + 1 < last; ++index) {
+						if (!chain.skipped(index)) {
+								run_handler(chain, index, record, [&] { std::apply(chain[index], args); });
+						}
+				}
+				if (chain.skipped(last - 1)) {
+						return;
+				}
+				run_handler(chain, last - 1, record, [&] {
+						if (consume_last) {
+								std::apply([&](auto&... stored) { chain[last - 1](consume(stored)...); }, args);
+						}
+						else {
+								std::apply(chain[last - 1], args);
+						}
+				});
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename CallT>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::run_handler(handler_chain_type& chain,
+						size_t index,
+						[[maybe_unused]] signal_record* record,
+						CallT&& call)
+		{
+				if constexpr (PolicyT::collect_statistics) {
+						auto start = clock_type::now();
+						call();
+						auto slot = chain.id_at(index).index;
+						if (record != nullptr && slot != handler_chain_type::npos) {
+								record->handlers[slot].record(clock_type::now() - start);
+						}
+				}
+				else {
+						call();
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handle_event(const event_handlers& handlers, event_type& e)
+		{
+				signal_record* record = nullptr;
+				if constexpr (PolicyT::collect_statistics) {
+						// records are only added on the responding thread while no handler runs, so workers can look them up
+						auto found = m_records.find(e.signal);
+						record = (found != m_records.end()) ? &found->second : nullptr;
+						if (record != nullptr) {
+								record->handled.fetch_add(1, std::memory_order_relaxed);
+								record->queue_latency.record(clock_type::now() - e.pushed_at);
+						}
+				}
+				size_t patterns_end = (handlers.patterns != nullptr) ? live_patterns_end(*handlers.patterns) : 0;
+				if (handlers.chain != nullptr) {
+						call_chain(*handlers.chain, e.args, record, patterns_end == 0);
+				}
+				if (patterns_end > 0) {
+						call_patterns(*handlers.patterns, patterns_end, e.args);
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... ArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_handler(const SignalT& signal, ArgTs&&... args)
+		{
+				auto& chain = m_handler_map[signal];
+				if (!m_responding_now && m_emit_depth == 0) {
+						return connected(signal, chain.connect(std::forward<ArgTs>(args)...));
+				}
+				// a handler may be running from this chain, which must not move
+				auto slot = chain.connect_later(std::forward<ArgTs>(args)...);
+				if (!chain.compaction_queued) {
+						chain.compaction_queued = true;
+						m_compaction_queue.push_back(&chain);
+				}
+				return connected(signal, slot);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connected(const SignalT& signal,
+						const typename handler_chain_type::slot_id& slot)
+		{
+				if constexpr (PolicyT::collect_statistics) {
+						auto& handlers = m_records[signal].handlers;
+						while (handlers.size() <= slot.index) {
+								handlers.emplace_back();
+						}
+						// the slot may have belonged to a disconnected handler
+						handlers[slot.index].reset();
+				}
+				return { signal, slot.index, slot.generation };
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::note_queue_depth()
+		{
+				if constexpr (PolicyT::collect_statistics) {
+						m_queue_high_water = std::max(m_queue_high_water, queued_events());
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::publish_queue_size()
+		{
+				if constexpr (PolicyT::concurrent_producers) {
+						m_queue_size.store(queued_events(), std::memory_order_relaxed);
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::notify_queued()
+		{
+				if (!m_responding_now) {
+						m_wakeup.notify_handle();
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::statistics_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::statistics() const
+		{
+				static_assert(PolicyT::collect_statistics, "statistics are only recorded with policy::instrumented");
+				statistics_type snapshot;
+				snapshot.queue_high_water = m_queue_high_water;
+				for (auto& [signal, record] : m_records) {
+						signal_statistics stats{ signal,
+								record.pushed.load(std::memory_order_relaxed),
+								record.handled.load(std::memory_order_relaxed),
+								record.queue_latency,
+								{} };
+						auto chain = m_handler_map.find(signal);
+						if (chain != m_handler_map.end()) {
+								for (size_t position = 0; position < chain->second.size(); ++position) {
+										auto slot = chain->second.id_at(position);
+										if (slot.index != handler_chain_type::npos) {
+												stats.handlers.push_back({ { signal, slot.index, slot.generation }, record.handlers[slot.index] });
+										}
+								}
+						}
+						snapshot.signals.push_back(std::move(stats));
+				}
+				for (size_t index = 0; index < m_patterns.size(); ++index) {
+						auto& subscription = m_patterns[index];
+						if (subscription.live) {
+								SignalT signal = subscription.range.has_value() ? subscription.range->first : SignalT{};
+								snapshot.patterns.push_back({ { signal, index, subscription.generation, true }, subscription.run_time });
+						}
+				}
+				return snapshot;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::reset_statistics()
+		{
+				static_assert(PolicyT::collect_statistics, "statistics are only recorded with policy::instrumented");
+				for (auto& [signal, record] : m_records) {
+						record.pushed.store(0, std::memory_order_relaxed);
+						record.handled.store(0, std::memory_order_relaxed);
+						record.queue_latency.reset();
+						for (auto& handler : record.handlers) {
+								handler.reset();
+						}
+				}
+				for (auto& subscription : m_patterns) {
+						subscription.run_time.reset();
+				}
+				m_queue_high_water = queued_events();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::event_handlers
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::chain_cache::find(const SignalT& signal)
+		{
+				if (owner.m_handler_map.size() != known_chains) {
+						// a handler connected to a signal which had no chain, pattern only entries are looked up again
+						known_chains = owner.m_handler_map.size();
+						auto kept = std::remove_if(entries.begin(), entries.end(), [](const auto& entry) {
+								return entry.first != nullptr && entry.second.chain == nullptr;
+						});
+						std::fill(kept, entries.end(), std::pair<const SignalT*, event_handlers>{});
+				}
+				for (size_t i = 0; i < entries.size() && entries[i].first != nullptr; ++i) {
+						if (*entries[i].first == signal) {
+								// most recently used first
+								std::rotate(entries.begin(), entries.begin() + i, entries.begin() + i + 1);
+								return entries[0].second;
+						}
+				}
+				auto found = owner.m_handler_map.find(signal);
+				// remembered pattern matches are kept for the whole respond call as well, so their key can be cached
+				const SignalT* key = nullptr;
+				event_handlers handlers{ (found != owner.m_handler_map.end()) ? &found->second : nullptr,
+						owner.find_patterns(signal, &key) };
+				if (handlers.chain != nullptr) {
+						key = &found->first;
+				}
+				else if (handlers.patterns == nullptr) {
+						return handlers;
+				}
+				std::rotate(entries.begin(), entries.end() - 1, entries.end());
+				entries[0] = { key, handlers };
+				return entries[0].second;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename HandlerT>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_pattern(const SignalT& signal, HandlerT&& handler)
+		{
+				size_t index;
+				if (m_free_patterns.empty()) {
+						index = m_patterns.size();
+						m_patterns.emplace_back();
+				}
+				else {
+						// released by refresh_patterns, no handler of it is running
+						index = m_free_patterns.back();
+						m_free_patterns.pop_back();
+				}
+				auto& subscription = m_patterns[index];
+				subscription.handler.emplace(std::forward<HandlerT>(handler));
+				subscription.range.reset();
+				subscription.predicate.reset();
+				subscription.sequence = m_pattern_sequence++;
+				subscription.live = true;
+				if constexpr (PolicyT::collect_statistics) {
+						subscription.run_time.reset();
+				}
+				++m_live_patterns;
+				m_patterns_changed = true;
+				return { signal, index, subscription.generation, true };
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		bool
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::disconnect_pattern(const handler_id_type& handler_id)
+		{
+				if (handler_id.index >= m_patterns.size()) {
+						return false;
+				}
+				auto& subscription = m_patterns[handler_id.index];
+				if (!subscription.live || subscription.generation != handler_id.generation) {
+						return false;
+				}
+				subscription.live = false;
+				++subscription.generation;
+				if (!m_responding_now && m_emit_depth == 0) {
+						subscription.handler.reset();
+						m_free_patterns.push_back(handler_id.index);
+				}
+				else {
+						// like a handler of a chain, it may be running right now
+						m_disconnected_patterns.push_back(handler_id.index);
+				}
+				--m_live_patterns;
+				m_patterns_changed = true;
+				return true;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		const typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::pattern_matches_type*
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::find_patterns(const SignalT& signal, const SignalT** key)
+		{
+				if (m_live_patterns == 0) {
+						return nullptr;
+				}
+				if (!m_responding_now && m_emit_depth == 0) {
+						refresh_patterns();
+				}
+				auto [found, inserted] = m_pattern_matches.try_emplace(signal);
+				if (inserted) {
+						found->second = match_patterns(signal);
+				}
+				if (key != nullptr) {
+						*key = &found->first;
+				}
+				return found->second.empty() ? nullptr : &found->second;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::pattern_matches_type
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::match_patterns(const SignalT& signal) const
+		{
+				pattern_matches_type matches;
+				auto add = [&](size_t index) { matches.push_back({ index, m_patterns[index].generation }); };
+				for (auto index : m_any_patterns) {
+						add(index);
+				}
+				if constexpr (is_ordered_v<SignalT>) {
+						m_range_index.query(signal, add);
+				}
+				for (auto index : m_predicate_patterns) {
+						if (m_patterns[index].predicate.value()(signal)) {
+								add(index);
+						}
+				}
+				std::sort(matches.begin(), matches.end(), [&](const pattern_match& lhs, const pattern_match& rhs) {
+						return m_patterns[lhs.index].sequence < m_patterns[rhs.index].sequence;
+				});
+				return matches;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::refresh_patterns()
+		{
+				for (auto index : m_disconnected_patterns) {
+						m_patterns[index].handler.reset();
+						m_free_patterns.push_back(index);
+				}
+				m_disconnected_patterns.clear();
+				if (!m_patterns_changed) {
+						if (m_pattern_matches.size() > max_remembered_signals) {
+								m_pattern_matches.clear();
+						}
+						return;
+				}
+				m_patterns_changed = false;
+				m_pattern_matches.clear();
+				m_any_patterns.clear();
+				m_predicate_patterns.clear();
+				std::vector<typename interval_index<SignalT, size_t>::interval> ranges;
+				for (size_t index = 0; index < m_patterns.size(); ++index) {
+						auto& subscription = m_patterns[index];
+						if (!subscription.live) {
+								continue;
+						}
+						if (subscription.range.has_value()) {
+								ranges.push_back({ subscription.range->first, subscription.range->second, index });
+						}
+						else if (subscription.predicate.has_value()) {
+								m_predicate_patterns.push_back(index);
+						}
+						else {
+								m_any_patterns.push_back(index);
+						}
+				}
+				if constexpr (is_ordered_v<SignalT>) {
+						m_range_index.assign(std::move(ranges));
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::pattern_subscription*
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::live_pattern(const pattern_match& match)
+		{
+				auto& subscription = m_patterns[match.index];
+				return (subscription.live && subscription.generation == match.generation) ? &subscription : nullptr;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename CallT>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::run_pattern(pattern_subscription& subscription, CallT&& call)
+		{
+				// the subscription stays in place even if its handler disconnects itself, see disconnect_pattern
+				if constexpr (PolicyT::collect_statistics) {
+						auto start = clock_type::now();
+						call(*subscription.handler);
+						subscription.run_time.record(clock_type::now() - start);
+				}
+				else {
+						call(*subscription.handler);
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::live_patterns_end(const pattern_matches_type& matches)
+		{
+				size_t end = matches.size();
+				while (end > 0 && live_pattern(matches[end - 1]) == nullptr) {
+						--end;
+				}
+				return end;
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::call_patterns(const pattern_matches_type& matches,
+						size_t end,
+						args_storage_type& args)
+		{
+				for (size_t index = 0; index + 1 < end; ++index) {
+						if (auto subscription = live_pattern(matches[index])) {
+								run_pattern(*subscription, [&](handler_type& handler) { std::apply(handler, args); });
+						}
+				}
+				if (auto subscription = live_pattern(matches[end - 1])) {
+						run_pattern(*subscription, [&](handler_type& handler) {
+								std::apply([&](auto&... stored) { handler(consume(stored)...); }, args);
+						});
+				}
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::instance_type&
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::instance()
+		{
+				return instance_type::default_instance();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename HandlerT>
+		typename global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect(const SignalT& signal, HandlerT&& handler)
+		{
+				return instance().connect(signal, std::forward<HandlerT>(handler));
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename HandlerT, typename... BoundArgTs>
+		typename global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_bind(const SignalT& signal,
+						HandlerT&& handler,
+						BoundArgTs&&... bound_args)
+		{
+				return instance().connect_bind(signal, std::forward<HandlerT>(handler), std::forward<BoundArgTs>(bound_args)...);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename ClassT, typename MemPtrT>
+		typename global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_member(const SignalT& signal, ClassT&& object, MemPtrT member)
+		{
+				return instance().connect_member(signal, std::forward<ClassT>(object), member);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename ClassT, typename MemPtrT, typename... BoundArgTs>
+		typename global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_bind_member(const SignalT& signal,
+						ClassT&& object,
+						MemPtrT member,
+						BoundArgTs&&... bound_args)
+		{
+				return instance().connect_bind_member(
+						signal, std::forward<ClassT>(object), member, std::forward<BoundArgTs>(bound_args)...);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename HandlerT>
+		typename global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_any(HandlerT&& handler)
+		{
+				return instance().connect_any(std::forward<HandlerT>(handler));
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename HandlerT>
+		typename global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_range(const SignalT& first,
+						const SignalT& last,
+						HandlerT&& handler)
+		{
+				return instance().connect_range(first, last, std::forward<HandlerT>(handler));
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename HandlerT>
+		typename global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_if(typename instance_type::predicate_type predicate,
+						HandlerT&& handler)
+		{
+				return instance().connect_if(std::move(predicate), std::forward<HandlerT>(handler));
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		bool
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event(const SignalT& signal, FwdHandlerArgTs&&... args)
+		{
+				return instance().push_event(signal, std::forward<FwdHandlerArgTs>(args)...);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		bool
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event(priority prio,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args)
+		{
+				return instance().push_event(prio, signal, std::forward<FwdHandlerArgTs>(args)...);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename RangeT>
+		size_t
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_events(const SignalT& signal, RangeT&& range)
+		{
+				return instance().push_events(signal, std::forward<RangeT>(range));
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename RangeT>
+		size_t
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_events(RangeT&& range)
+		{
+				return instance().push_events(std::forward<RangeT>(range));
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		void
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::emit(const SignalT& signal, FwdHandlerArgTs&&... args)
+		{
+				instance().emit(signal, std::forward<FwdHandlerArgTs>(args)...);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		overflow_stats
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::overflow_counters()
+		{
+				return instance().overflow_counters();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::statistics_type
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::statistics()
+		{
+				return instance().statistics();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::reset_statistics()
+		{
+				instance().reset_statistics();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::coalesce(const SignalT& signal)
+		{
+				instance().coalesce(signal);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::coalesce(const SignalT& signal,
+						typename instance_type::merge_type merge)
+		{
+				instance().coalesce(signal, std::move(merge));
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::stop_coalescing(const SignalT& signal)
+		{
+				instance().stop_coalescing(signal);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		typename global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::instance_type::timer_id_type
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event_at(
+						typename instance_type::clock_type::time_point due,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args)
+		{
+				return instance().push_event_at(due, signal, std::forward<FwdHandlerArgTs>(args)...);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		typename global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::instance_type::timer_id_type
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event_after(
+						typename instance_type::clock_type::duration delay,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args)
+		{
+				return instance().push_event_after(delay, signal, std::forward<FwdHandlerArgTs>(args)...);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		template<typename... FwdHandlerArgTs>
+		typename global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::instance_type::timer_id_type
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event_every(
+						typename instance_type::clock_type::duration period,
+						const SignalT& signal,
+						FwdHandlerArgTs&&... args)
+		{
+				return instance().push_event_every(period, signal, std::forward<FwdHandlerArgTs>(args)...);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		bool
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::cancel_timer(
+						const typename instance_type::timer_id_type& timer_id)
+		{
+				return instance().cancel_timer(timer_id);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::timers_pending()
+		{
+				return instance().timers_pending();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::events_pending()
+		{
+				return instance().events_pending();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::respond(size_t limit)
+		{
+				return instance().respond(limit);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::respond_until(
+						typename instance_type::clock_type::time_point deadline)
+		{
+				return instance().respond_until(deadline);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::respond_for(typename instance_type::clock_type::duration budget)
+		{
+				return instance().respond_for(budget);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::wait_and_respond(
+						typename instance_type::clock_type::duration timeout)
+		{
+				return instance().wait_and_respond(timeout);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::wake()
+		{
+				instance().wake();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::clear_wake()
+		{
+				instance().clear_wake();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		int
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::wakeup_handle()
+		{
+				return instance().wakeup_handle();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::clock_type::time_point
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::next_timer_due()
+		{
+				return instance().next_timer_due();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		size_t
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::respond(thread_pool& pool, ordering order, size_t limit)
+		{
+				return instance().respond(pool, order, limit);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		bool
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::disconnect(const handler_id_type& handler_id)
+		{
+				return instance().disconnect(handler_id);
+		}
+
+#ifdef HANDLEBARS_COROUTINES
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		typename basic_dispatcher<PolicyT, SignalT, HandlerArgTs...>::next_awaiter
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::next(const SignalT& signal)
+		{
+				return instance().next(signal);
+		}
+#endif
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::update_events(const tmf::callable<void(event_queue_type&)>& updater)
+		{
+				instance().update_events(updater);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::record(journal_writer& journal)
+		{
+				instance().record(journal);
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		void
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::stop_recording()
+		{
+				instance().stop_recording();
+		}
+
+		template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+		replay_stats
+				global_dispatcher<PolicyT, SignalT, HandlerArgTs...>::replay(journal_reader& journal, replay_timing timing)
+		{
+				return instance().replay(journal, timing);
 		}
 }
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "dispatcher.hpp"
+
+namespace handlebars {
+inline namespace detail {
+
+// what every event on an event bus starts with, the rest of it depends on the dispatcher it is for
+struct bus_entry
+{
+  // calls the handlers of the event, then destroys it
+  void (*dispatch)(bus_entry*);
+  // destroys the event without calling handlers
+  void (*discard)(bus_entry*);
+  // the entry pushed after this one, in whatever block
+  bus_entry* next;
+};
+
+// an event for the handlers of a dispatcher instance, its arguments are stored like the dispatcher stores them
+template<typename DispatcherT>
+struct bus_event : bus_entry
+{
+  DispatcherT* target;
+  typename DispatcherT::signal_type signal;
+  typename DispatcherT::args_storage_type args;
+
+  static void dispatch_event(bus_entry* entry)
+  {
+    auto* e = static_cast<bus_event*>(entry);
+    std::apply([e](auto&... stored) { e->target->emit(e->signal, consume(stored)...); }, e->args);
+    e->~bus_event();
+  }
+
+  static void discard_event(bus_entry* entry) { static_cast<bus_event*>(entry)->~bus_event(); }
+};
+}
+
+// one queue for the events of dispatchers of any signature, so an application using several of them responds to all
+// with one call and in the order the events were pushed. handlers stay connected to their dispatchers, respond calls
+// them like the dispatchers emit does. events are constructed in place one after another in blocks of BlockBytes,
+// which are reused once respond has gone through them, so pushing allocates nothing after the first few bursts.
+// single threaded like policy::defaults, the bus and its target dispatchers belong to the thread calling respond
+template<size_t BlockBytes = 64 * 1024>
+struct basic_event_bus
+{
+  basic_event_bus() = default;
+  basic_event_bus(const basic_event_bus&) = delete;
+  basic_event_bus& operator=(const basic_event_bus&) = delete;
+
+  // pending events are discarded
+  ~basic_event_bus();
+
+  // queues an event for the handlers target has connected to signal. arguments are stored like target.push_event
+  // would store them, references must stay valid until the event is handled. target must outlive the event
+  template<typename DispatcherT, typename... FwdHandlerArgTs>
+  void push_event(DispatcherT& target, const typename DispatcherT::signal_type& signal, FwdHandlerArgTs&&... args);
+
+  // like push_event(target, signal, args...) for the instance behind a static interface, such as
+  // bus.push_event<dispatcher<std::string, const std::string&>>("log", text)
+  template<typename GlobalDispatcherT, typename... FwdHandlerArgTs>
+  void push_event(const typename GlobalDispatcherT::signal_type& signal, FwdHandlerArgTs&&... args);
+
+  // handles up to limit events (0 for all pending) in the order they were pushed.
+  // events pushed by handlers wait for the next call. returns number of events that were handled, 0 right away when
+  // called from a handler
+  size_t respond(size_t limit = 0);
+
+  size_t events_pending() const;
+
+private:
+  struct block
+  {
+    std::unique_ptr<std::byte[]> data;
+    size_t size;
+    size_t used;
+
+    bool contains(const void* p) const { return p >= data.get() && p < data.get() + size; }
+  };
+
+  // room for size bytes at alignment at the end of the queue
+  void* allocate(size_t size, size_t alignment);
+
+  // hands blocks that respond has gone through back to the free list
+  void recycle_blocks();
+
+  // blocks in the order they were filled, the last one is written to
+  std::deque<block> m_blocks;
+  // emptied blocks of BlockBytes, larger blocks made for a single big event are freed instead
+  std::vector<block> m_free;
+  bus_entry* m_head = nullptr;
+  bus_entry* m_tail = nullptr;
+  size_t m_pending = 0;
+  // set while respond calls handlers
+  bool m_responding = false;
+};
+
+// event bus with the default block size
+using event_bus = basic_event_bus<>;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////Implementation//////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template<size_t BlockBytes>
+basic_event_bus<BlockBytes>::~basic_event_bus()
+{
+  while (m_head != nullptr) {
+    bus_entry* entry = m_head;
+    m_head = entry->next;
+    entry->discard(entry);
+  }
+}
+
+template<size_t BlockBytes>
+template<typename DispatcherT, typename... FwdHandlerArgTs>
+void
+basic_event_bus<BlockBytes>::push_event(DispatcherT& target,
+                                        const typename DispatcherT::signal_type& signal,
+                                        FwdHandlerArgTs&&... args)
+{
+  using event_type = bus_event<DispatcherT>;
+  auto* e = ::new (allocate(sizeof(event_type), alignof(event_type))) event_type{
+    { &event_type::dispatch_event, &event_type::discard_event, nullptr },
+    &target,
+    signal,
+    typename DispatcherT::args_storage_type{ std::forward<FwdHandlerArgTs>(args)... }
+  };
+  if (m_tail != nullptr) {
+    m_tail->next = e;
+  }
+  else {
+    m_head = e;
+  }
+  m_tail = e;
+  ++m_pending;
+}
+
+template<size_t BlockBytes>
+template<typename GlobalDispatcherT, typename... FwdHandlerArgTs>
+void
+basic_event_bus<BlockBytes>::push_event(const typename GlobalDispatcherT::signal_type& signal, FwdHandlerArgTs&&... args)
+{
+  push_event(GlobalDispatcherT::instance(), signal, std::forward<FwdHandlerArgTs>(args)...);
+}
+
+template<size_t BlockBytes>
+size_t
+basic_event_bus<BlockBytes>::respond(size_t limit)
+{
+  if (m_responding) {
+    // called by a handler, the outer call is still working through its events
+    return 0;
+  }
+  m_responding = true;
+  size_t count = (limit == 0) ? m_pending : std::min(limit, m_pending);
+  for (size_t handled = 0; handled < count; ++handled) {
+    bus_entry* entry = m_head;
+    m_head = entry->next;
+    if (m_head == nullptr) {
+      m_tail = nullptr;
+    }
+    --m_pending;
+    entry->dispatch(entry);
+    recycle_blocks();
+  }
+  m_responding = false;
+  return count;
+}
+
+template<size_t BlockBytes>
+size_t
+basic_event_bus<BlockBytes>::events_pending() const
+{
+  return m_pending;
+}
+
+template<size_t BlockBytes>
+void*
+basic_event_bus<BlockBytes>::allocate(size_t size, size_t alignment)
+{
+  if (!m_blocks.empty()) {
+    auto& last = m_blocks.back();
+    void* p = last.data.get() + last.used;
+    size_t space = last.size - last.used;
+    if (std::align(alignment, size, p, space) != nullptr) {
+      last.used = last.size - space + size;
+      return p;
+    }
+  }
+  if (size + alignment <= BlockBytes && !m_free.empty()) {
+    m_blocks.push_back(std::move(m_free.back()));
+    m_free.pop_back();
+  }
+  else {
+    size_t bytes = std::max(BlockBytes, size + alignment);
+    m_blocks.push_back(block{ std::unique_ptr<std::byte[]>(new std::byte[bytes]), bytes, 0 });
+  }
+  auto& last = m_blocks.back();
+  void* p = last.data.get();
+  size_t space = last.size;
+  std::align(alignment, size, p, space);
+  last.used = last.size - space + size;
+  return p;
+}
+
+template<size_t BlockBytes>
+void
+basic_event_bus<BlockBytes>::recycle_blocks()
+{
+  // entries never span blocks, a block the head is not in has been gone through, unless it is still written to
+  while (!m_blocks.empty() && (m_head == nullptr || !m_blocks.front().contains(m_head))) {
+    if (m_blocks.size() == 1) {
+      if (m_head == nullptr) {
+        m_blocks.front().used = 0;
+      }
+      return;
+    }
+    if (m_blocks.front().size == BlockBytes) {
+      m_blocks.front().used = 0;
+      m_free.push_back(std::move(m_blocks.front()));
+    }
+    m_blocks.pop_front();
+  }
+}
+}
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "../dispatcher.hpp"
+
+namespace handlebars::fast {
+
+inline namespace detail {
+
+// reads an optional configuration identifier out of the signal enum, falling back to a default
+template<typename SignalT, typename = void>
+struct max_handlers_per_signal : std::integral_constant<size_t, 8>
+{};
+template<typename SignalT>
+struct max_handlers_per_signal<SignalT, std::void_t<decltype(SignalT::max_handlers_per_signal)>>
+  : std::integral_constant<size_t, static_cast<size_t>(SignalT::max_handlers_per_signal)>
+{};
+
+template<typename SignalT, typename = void>
+struct max_events_enqueued : std::integral_constant<size_t, 1024>
+{};
+template<typename SignalT>
+struct max_events_enqueued<SignalT, std::void_t<decltype(SignalT::max_events_enqueued)>>
+  : std::integral_constant<size_t, static_cast<size_t>(SignalT::max_events_enqueued)>
+{};
+}
+
+// a dispatcher for enum class signals whose storage is entirely decided at compile-time.
+// handler chains live in a std::array indexed by the signals ordinal and the event queue is a fixed size ring buffer,
+// so connecting, pushing and responding never allocate and never hash.
+// SignalT must list its signals starting at 0, followed by "enum_size", optionally followed by
+// "max_handlers_per_signal = N" and "max_events_enqueued = N", see "docs/advanced_usage.md"
+template<typename SignalT, typename... HandlerArgTs>
+struct dispatcher
+{
+  static_assert(std::is_enum_v<SignalT>, "handlebars::fast::dispatcher requires an enum class signal type");
+
+  // number of distinct signals, taken from SignalT::enum_size
+  static constexpr size_t signal_count = static_cast<size_t>(SignalT::enum_size);
+  // how many handlers can be connected to one signal at any one time
+  static constexpr size_t handler_capacity = max_handlers_per_signal<SignalT>::value;
+  // how many events can be pending at any one time
+  static constexpr size_t event_capacity = max_events_enqueued<SignalT>::value;
+
+  static_assert(signal_count > 0, "SignalT::enum_size must come after at least one signal");
+  static_assert(handler_capacity > 0 && event_capacity > 0, "capacities must be positive");
+
+  // see "dispatcher.hpp"
+  using signal_type = SignalT;
+  using handler_type = tmf::callable<void(HandlerArgTs...)>;
+  using args_storage_type = std::tuple<arg_storage_t<HandlerArgTs>...>;
+  // a handler chain is a fixed amount of handler slots, empty slots are skipped
+  using handler_chain_type = std::array<std::optional<handler_type>, handler_capacity>;
+  // the handler map is indexed directly by signal ordinal
+  using handler_map_type = std::array<handler_chain_type, signal_count>;
+  struct handler_id_type
+  {
+    SignalT signal;
+    size_t index;
+
+    // false if the handler chain was full when connecting, such an id is ignored by disconnect
+    bool connected() const { return index < handler_capacity; }
+  };
+  struct event_type
+  {
+    signal_type signal;
+    args_storage_type args;
+  };
+
+  // associates a SignalT signal with a callable entity (any lambda, free function, static member function
+  // or function object)
+  template<typename HandlerT>
+  static handler_id_type connect(SignalT signal, HandlerT&& handler);
+
+  // associates a SignalT signal with a callable entity, after binding arguments to it
+  template<typename HandlerT, typename... BoundArgTs>
+  static handler_id_type connect_bind(SignalT signal, HandlerT&& handler, BoundArgTs&&... bound_args);
+
+  // associates a SignalT signal with a member function pointer of a class instance
+  // ClassT must be either a raw pointer or shared_ptr
+  template<typename ClassT, typename MemPtrT>
+  static handler_id_type connect_member(SignalT signal, ClassT&& object, MemPtrT member);
+
+  // associates a SignalT signal with a member function pointer of a class instance, after binding arguments to it
+  // ClassT must be either a raw pointer or shared_ptr
+  template<typename ClassT, typename MemPtrT, typename... BoundArgTs>
+  static handler_id_type connect_bind_member(SignalT signal, ClassT&& object, MemPtrT member, BoundArgTs&&... bound_args);
+
+  // pushes a new event onto the queue with a signal value and arguments, if any.
+  // returns false and drops the event if "event_capacity" events are already pending
+  template<typename... FwdHandlerArgTs>
+  static bool push_event(SignalT signal, FwdHandlerArgTs&&... args);
+
+  // returns the size of the event queue
+  static size_t events_pending();
+
+  // handles events and pops them off of the event queue.
+  // the amount can be specified by limit.
+  // if limit is 0, then all events pending at the time of the call are executed.
+  // returns number of events that were succesfully handled, 0 right away when called from a handler
+  static size_t respond(size_t limit = 0);
+
+  //  this removes an event handler from a handler list.
+  //  a handler disconnected while respond runs is not called again, but it is only destroyed once respond is done,
+  //  since it may be the handler that is running
+  static void disconnect(const handler_id_type& handler_id);
+
+private:
+  dispatcher() {}
+
+  // places a handler into the first free slot of a chain
+  template<typename... HandlerCtorArgTs>
+  static handler_id_type emplace_handler(SignalT signal, HandlerCtorArgTs&&... handler_args);
+
+  // whether the slot holds a handler which has not been disconnected
+  static bool connected_at(size_t ordinal, size_t index);
+
+  // destroys the handlers disconnected while respond was running
+  static void release_disconnected();
+
+  inline static handler_map_type m_handler_map{};
+  // one past the last occupied slot of each chain, respond never looks further
+  inline static std::array<size_t, signal_count> m_chain_ends{};
+  // set while respond calls handlers
+  inline static bool m_responding = false;
+  // slots whose handler was disconnected while respond was running, they stay occupied until it is done
+  inline static std::array<std::bitset<handler_capacity>, signal_count> m_disconnected{};
+  inline static size_t m_disconnected_count = 0;
+  // ring buffer, m_events_front is the oldest event
+  inline static std::array<std::optional<event_type>, event_capacity> m_events{};
+  inline static size_t m_events_front = 0;
+  inline static size_t m_events_size = 0;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////Implementation//////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template<typename SignalT, typename... HandlerArgTs>
+template<typename... HandlerCtorArgTs>
+typename dispatcher<SignalT, HandlerArgTs...>::handler_id_type
+dispatcher<SignalT, HandlerArgTs...>::emplace_handler(SignalT signal, HandlerCtorArgTs&&... handler_args)
+{
+  auto ordinal = static_cast<size_t>(signal);
+  auto& chain = m_handler_map[ordinal];
+  for (size_t index = 0; index < handler_capacity; ++index) {
+    if (!chain[index].has_value()) {
+      chain[index].emplace(std::forward<HandlerCtorArgTs>(handler_args)...);
+      m_chain_ends[ordinal] = std::max(m_chain_ends[ordinal], index + 1);
+      return { signal, index };
+    }
+  }
+  return { signal, handler_capacity };
+}
+
+template<typename SignalT, typename... HandlerArgTs>
+template<typename HandlerT>
+typename dispatcher<SignalT, HandlerArgTs...>::handler_id_type
+dispatcher<SignalT, HandlerArgTs...>::connect(SignalT signal, HandlerT&& handler)
+{
+  return emplace_handler(signal, std::forward<HandlerT>(handler));
+}
+
+template<typename SignalT, typename... HandlerArgTs>
+template<typename HandlerT, typename... BoundArgTs>
+typename dispatcher<SignalT, HandlerArgTs...>::handler_id_type
+dispatcher<SignalT, HandlerArgTs...>::connect_bind(SignalT signal, HandlerT&& handler, BoundArgTs&&... bound_args)
+{
+  return emplace_handler(signal,
+                         [handler = std::forward<HandlerT>(handler),
+                          bound_tuple = std::make_tuple(std::forward<BoundArgTs>(bound_args)...)](HandlerArgTs... args) {
+                           std::apply(
+                             [&](auto&... bound) { handler(bound..., std::forward<HandlerArgTs>(args)...); },
+                             bound_tuple);
+                         });
+}
+
+template<typename SignalT, typename... HandlerArgTs>
+template<typename ClassT, typename MemPtrT>
+typename dispatcher<SignalT, HandlerArgTs...>::handler_id_type
+dispatcher<SignalT, HandlerArgTs...>::connect_member(SignalT signal, ClassT&& object, MemPtrT member)
+{
+  return emplace_handler(signal, std::forward<ClassT>(object), member);
+}
+
+template<typename SignalT, typename... HandlerArgTs>
+template<typename ClassT, typename MemPtrT, typename... BoundArgTs>
+typename dispatcher<SignalT, HandlerArgTs...>::handler_id_type
+dispatcher<SignalT, HandlerArgTs...>::connect_bind_member(SignalT signal,
+                                                          ClassT&& object,
+                                                          MemPtrT member,
+                                                          BoundArgTs&&... bound_args)
+{
+  return emplace_handler(signal,
+                         [object = std::forward<ClassT>(object),
+                          member,
+                          bound_tuple = std::make_tuple(std::forward<BoundArgTs>(bound_args)...)](HandlerArgTs... args) {
+                           std::apply(
+                             [&](auto&... bound) { ((*object).*member)(bound..., std::forward<HandlerArgTs>(args)...); },
+                             bound_tuple);
+                         });
+}
+
+template<typename SignalT, typename... HandlerArgTs>
+template<typename... FwdHandlerArgTs>
+bool
+dispatcher<SignalT, HandlerArgTs...>::push_event(SignalT signal, FwdHandlerArgTs&&... args)
+{
+  if (m_events_size == event_capacity) {
+    return false;
+  }
+  m_events[(m_events_front + m_events_size) % event_capacity].emplace(
+    event_type{ signal, args_storage_type{ std::forward<FwdHandlerArgTs>(args)... } });
+  ++m_events_size;
+  return true;
+}
+
+template<typename SignalT, typename... HandlerArgTs>
+size_t
+dispatcher<SignalT, HandlerArgTs...>::events_pending()
+{
+  return m_events_size;
+}
+
+template<typename SignalT, typename... HandlerArgTs>
+size_t
+dispatcher<SignalT, HandlerArgTs...>::respond(size_t limit)
+{
+  if (m_responding) {
+    // called by a handler, the outer call is still handling the front event
+    return 0;
+  }
+  // events pushed by handlers during this call wait for the next one
+  size_t count = (limit == 0) ? m_events_size : std::min(limit, m_events_size);
+  m_responding = true;
+  for (size_t progress = 0; progress < count; ++progress) {
+    // the slot stays occupied while its handlers run, so events they push can not overwrite it
+    auto& slot = m_events[m_events_front];
+    auto ordinal = static_cast<size_t>(slot->signal);
+    auto& chain = m_handler_map[ordinal];
+    size_t last = m_chain_ends[ordinal];
+    for (size_t index = 0; index + 1 < last; ++index) {
+      if (connected_at(ordinal, index)) {
+        std::apply(chain[index].value(), slot->args);
+      }
+    }
+    // the last handler may move arguments out of the event, unless an earlier handler disconnected it
+    if (last > 0 && connected_at(ordinal, last - 1)) {
+      std::apply([&](auto&... stored) { chain[last - 1].value()(consume(stored)...); }, slot->args);
+    }
+    slot.reset();
+    m_events_front = (m_events_front + 1) % event_capacity;
+    --m_events_size;
+  }
+  m_responding = false;
+  release_disconnected();
+  return count;
+}
+
+template<typename SignalT, typename... HandlerArgTs>
+void
+dispatcher<SignalT, HandlerArgTs...>::disconnect(const handler_id_type& handler_id)
+{
+  if (!handler_id.connected()) {
+    return;
+  }
+  auto ordinal = static_cast<size_t>(handler_id.signal);
+  if (!connected_at(ordinal, handler_id.index)) {
+    return;
+  }
+  if (m_responding) {
+    // the handler may be running, it keeps its slot until respond is done
+    m_disconnected[ordinal].set(handler_id.index);
+    ++m_disconnected_count;
+  }
+  else {
+    m_handler_map[ordinal][handler_id.index].reset();
+  }
+  while (m_chain_ends[ordinal] > 0 && !connected_at(ordinal, m_chain_ends[ordinal] - 1)) {
+    --m_chain_ends[ordinal];
+  }
+}
+
+template<typename SignalT, typename... HandlerArgTs>
+bool
+dispatcher<SignalT, HandlerArgTs...>::connected_at(size_t ordinal, size_t index)
+{
+  return m_handler_map[ordinal][index].has_value() && !m_disconnected[ordinal].test(index);
+}
+
+template<typename SignalT, typename... HandlerArgTs>
+void
+dispatcher<SignalT, HandlerArgTs...>::release_disconnected()
+{
+  for (size_t ordinal = 0; ordinal < signal_count && m_disconnected_count > 0; ++ordinal) {
+    for (size_t index = 0; index < handler_capacity && m_disconnected[ordinal].any(); ++index) {
+      if (m_disconnected[ordinal].test(index)) {
+        m_disconnected[ordinal].reset(index);
+        m_handler_map[ordinal][index].reset();
+        --m_disconnected_count;
+      }
+    }
+  }
+}
+}
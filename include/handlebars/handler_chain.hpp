@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace handlebars {
+inline namespace detail {
+
+// the handlers connected to one signal, kept densely in connection order so calling them is a plain loop.
+// handlers are addressed through slots with generation counters, a slot is reused right after its handler is
+// disconnected and its generation makes every id of the previous handler stale.
+// a released handler is replaced by a no-op tombstone instead of being erased, so tombstones are called like any other
+// handler and compact() erases them later on. while the chain is being called nothing in it moves: handlers connected
+// meanwhile wait in a list of their own and disconnected ones stay in place, skipped, until release()
+template<typename HandlerT>
+struct handler_chain
+{
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  struct slot_id
+  {
+    size_t index;
+    size_t generation;
+  };
+
+  // appends a handler constructed from args, must not be called while the chain is being called
+  template<typename... ArgTs>
+  slot_id connect(ArgTs&&... args)
+  {
+    merge_connected();
+    m_handlers.emplace_back(std::forward<ArgTs>(args)...);
+    m_live_end = m_handlers.size();
+    return add_slot();
+  }
+
+  // like connect, while the chain may be being called. the handler is appended by the next release or compact
+  template<typename... ArgTs>
+  slot_id connect_later(ArgTs&&... args)
+  {
+    m_connected.emplace_back(std::forward<ArgTs>(args)...);
+    return add_slot();
+  }
+
+  // marks the handler of id disconnected, it is skipped from now on but stays in place until release or compact.
+  // false if id is stale
+  bool disconnect(const slot_id& id)
+  {
+    if (!connected(id)) {
+      return false;
+    }
+    size_t position = m_slots[id.index].position;
+    m_slot_of[position] = npos;
+    m_slots[id.index] = { npos, id.generation + 1 };
+    m_free_slots.push_back(id.index);
+    m_disconnected.push_back(position);
+    while (m_live_end > 0 && m_slot_of[m_live_end - 1] == npos) {
+      --m_live_end;
+    }
+    return true;
+  }
+
+  bool connected(const slot_id& id) const
+  {
+    return id.index < m_slots.size() && m_slots[id.index].generation == id.generation
+           && m_slots[id.index].position != npos;
+  }
+
+  // replaces disconnected handlers with the tombstones make_tombstone returns, whatever they held is freed, and
+  // appends the handlers of connect_later. must not be called while the chain is being called
+  template<typename MakeT>
+  void release(MakeT&& make_tombstone)
+  {
+    for (auto position : m_disconnected) {
+      if (position < m_handlers.size()) {
+        m_handlers[position] = make_tombstone();
+      }
+      else {
+        m_connected[position - m_handlers.size()] = make_tombstone();
+      }
+    }
+    m_tombstones += m_disconnected.size();
+    m_disconnected.clear();
+    merge_connected();
+  }
+
+  // once tombstones make up a quarter of the chain, so compaction costs O(1) per disconnect
+  bool needs_compaction() const
+  {
+    size_t disconnected = m_tombstones + m_disconnected.size();
+    return disconnected > 0 && disconnected * 4 >= size();
+  }
+
+  // erases tombstones and disconnected handlers, keeping the order of the live handlers, and appends the handlers of
+  // connect_later. must not be called while the chain is being called
+  void compact()
+  {
+    merge_connected();
+    size_t kept = 0;
+    for (size_t position = 0; position < m_handlers.size(); ++position) {
+      if (m_slot_of[position] == npos) {
+        continue;
+      }
+      if (kept != position) {
+        m_handlers[kept] = std::move(m_handlers[position]);
+        m_slot_of[kept] = m_slot_of[position];
+      }
+      m_slots[m_slot_of[kept]].position = kept;
+      ++kept;
+    }
+    m_handlers.erase(m_handlers.begin() + kept, m_handlers.end());
+    m_slot_of.resize(kept);
+    m_disconnected.clear();
+    m_tombstones = 0;
+    m_live_end = kept;
+  }
+
+  // handlers behind the last live one are tombstones, calls only need to go up to here
+  size_t live_end() const { return m_live_end; }
+
+  // whether the handler at position was disconnected since the last release. it must not be called, but it may be the
+  // one running so it is not replaced yet. tombstones are only checked while there are such handlers
+  bool skipped(size_t position) const { return !m_disconnected.empty() && m_slot_of[position] == npos; }
+
+  // handlers, tombstones and handlers waiting for release
+  size_t size() const { return m_handlers.size() + m_connected.size(); }
+
+  // the slot of the handler at position, with an index of npos for tombstones
+  slot_id id_at(size_t position) const
+  {
+    size_t index = m_slot_of[position];
+    return { index, (index == npos) ? 0 : m_slots[index].generation };
+  }
+
+  HandlerT& operator[](size_t position) { return m_handlers[position]; }
+
+  // set while the chain waits for release or compaction, see basic_dispatcher
+  bool compaction_queued = false;
+
+private:
+  struct slot
+  {
+    // where the handler is in m_handlers, followed by m_connected, npos while the slot is free
+    size_t position;
+    size_t generation;
+  };
+
+  // gives the handler appended last a slot
+  slot_id add_slot()
+  {
+    size_t index;
+    if (m_free_slots.empty()) {
+      index = m_slots.size();
+      m_slots.push_back({ npos, 0 });
+    } else {
+      index = m_free_slots.back();
+      m_free_slots.pop_back();
+    }
+    m_slots[index].position = m_slot_of.size();
+    m_slot_of.push_back(index);
+    return { index, m_slots[index].generation };
+  }
+
+  // appends the handlers of connect_later, their positions already count on it
+  void merge_connected()
+  {
+    if (m_connected.empty()) {
+      return;
+    }
+    for (auto& handler : m_connected) {
+      m_handlers.push_back(std::move(handler));
+    }
+    m_connected.clear();
+    m_live_end = m_handlers.size();
+    while (m_live_end > 0 && m_slot_of[m_live_end - 1] == npos) {
+      --m_live_end;
+    }
+  }
+
+  std::vector<HandlerT> m_handlers;
+  // handlers connected while the chain may have been called
+  std::vector<HandlerT> m_connected;
+  // the slot of every handler in m_handlers and m_connected, npos for tombstones and disconnected handlers
+  std::vector<size_t> m_slot_of;
+  std::vector<slot> m_slots;
+  std::vector<size_t> m_free_slots;
+  // positions of handlers disconnected since the last release
+  std::vector<size_t> m_disconnected;
+  size_t m_tombstones = 0;
+  size_t m_live_end = 0;
+};
+}
+}
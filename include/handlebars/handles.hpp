@@ -8,85 +8,143 @@
 
 namespace handlebars {
 
-// handles is a crtp style class which turns the derived class into a container for event handlers
+// basic_handles is a crtp style class which turns the derived class into a container for event handlers
 // and exposes some convenience functions
 // DerivedT must be the same type as the class which inherits this class
-template<typename DerivedT, typename SignalT, typename... HandlerArgTs>
-struct handles
+// DispatcherT is the dispatcher instance type handlers are connected to, such as basic_dispatcher<...>
+template<typename DerivedT, typename DispatcherT>
+struct basic_handles
 {
   // see dispatcher.hpp
-  using handler_id_type = typename dispatcher<SignalT, HandlerArgTs...>::handler_id_type;
+  using dispatcher_type = DispatcherT;
+  using signal_type = typename DispatcherT::signal_type;
+  using handler_id_type = typename DispatcherT::handler_id_type;
 
 protected:
-  // performs dispatcher<SignalT,HandlerArgTs...>::connect_member(...) on a member function of the derived class
+  // targets the default instance, which is shared with the static interface of the dispatcher
+  basic_handles();
+
+  // targets a specific dispatcher instance, which must outlive this object
+  explicit basic_handles(DispatcherT& target);
+
+  // performs DispatcherT::connect_member(...) on a member function of the derived class
   template<typename MemPtrT>
-  handler_id_type connect(const SignalT& signal, MemPtrT handler);
+  handler_id_type connect(const signal_type& signal, MemPtrT handler);
 
-  // performs dispatcher<SignalT,HandlerArgTs...>::connect_bind_member(...) on a member function of the derived class
+  // performs DispatcherT::connect_bind_member(...) on a member function of the derived class
   template<typename MemPtrT, typename... BoundArgTs>
-  handler_id_type connect_bind(const SignalT& signal, MemPtrT handler, BoundArgTs&&... bound_args);
+  handler_id_type connect_bind(const signal_type& signal, MemPtrT handler, BoundArgTs&&... bound_args);
 
 public:
-  // pushes a new event onto the queue with a signal value and arguments, if any
+  // pushes a new event onto the queue with a signal value and arguments, if any.
+  // returns false if the target dispatcher turned the event away
+  template<typename... FwdHandlerArgTs>
+  bool push_event(const signal_type& signal, FwdHandlerArgTs&&... args);
+
+  // pushes a new event with a priority, see policy::prioritized
+  template<typename... FwdHandlerArgTs>
+  bool push_event(priority prio, const signal_type& signal, FwdHandlerArgTs&&... args);
+
+  // calls the handlers of signal right away, see basic_dispatcher::emit
   template<typename... FwdHandlerArgTs>
-  void push_event(const SignalT& signal, FwdHandlerArgTs&&... args);
+  void emit(const signal_type& signal, FwdHandlerArgTs&&... args);
 
-  // calls global dispatcher respond function
+  // calls the target dispatchers respond function
   size_t respond(size_t limit = 0);
 
-  // destructor, removes handlers that correspond to this class instance from global dispatcher
-  ~handles();
+  // the dispatcher instance this object connects its handlers to
+  DispatcherT& target() const;
+
+  // destructor, removes handlers that correspond to this class instance from the target dispatcher
+  ~basic_handles();
 
 private:
+  DispatcherT* m_dispatcher;
   std::vector<handler_id_type> m_handlers;
 };
 
+// handles for the default single threaded dispatcher of an event signature
+template<typename DerivedT, typename SignalT, typename... HandlerArgTs>
+using handles = basic_handles<DerivedT, basic_dispatcher<policy::defaults, SignalT, HandlerArgTs...>>;
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////Implementation//////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-template<typename DerivedT, typename SignalT, typename... HandlerArgTs>
+template<typename DerivedT, typename DispatcherT>
+basic_handles<DerivedT, DispatcherT>::basic_handles()
+  : m_dispatcher(&DispatcherT::default_instance())
+{}
+
+template<typename DerivedT, typename DispatcherT>
+basic_handles<DerivedT, DispatcherT>::basic_handles(DispatcherT& target)
+  : m_dispatcher(&target)
+{}
+
+template<typename DerivedT, typename DispatcherT>
 template<typename MemPtrT>
-typename handles<DerivedT, SignalT, HandlerArgTs...>::handler_id_type
-handles<DerivedT, SignalT, HandlerArgTs...>::connect(const SignalT& signal, MemPtrT handler)
+typename basic_handles<DerivedT, DispatcherT>::handler_id_type
+basic_handles<DerivedT, DispatcherT>::connect(const signal_type& signal, MemPtrT handler)
 {
-  m_handlers.push_back(
-    dispatcher<SignalT, HandlerArgTs...>::connect_member(signal, static_cast<DerivedT*>(this), handler));
+  m_handlers.push_back(m_dispatcher->connect_member(signal, static_cast<DerivedT*>(this), handler));
   return m_handlers.back();
 }
 
-template<typename DerivedT, typename SignalT, typename... HandlerArgTs>
+template<typename DerivedT, typename DispatcherT>
 template<typename MemPtrT, typename... BoundArgTs>
-typename handles<DerivedT, SignalT, HandlerArgTs...>::handler_id_type
-handles<DerivedT, SignalT, HandlerArgTs...>::connect_bind(const SignalT& signal,
-                                                          MemPtrT handler,
-                                                          BoundArgTs&&... bound_args)
+typename basic_handles<DerivedT, DispatcherT>::handler_id_type
+basic_handles<DerivedT, DispatcherT>::connect_bind(const signal_type& signal,
+                                                   MemPtrT handler,
+                                                   BoundArgTs&&... bound_args)
 {
-  m_handlers.push_back(dispatcher<SignalT, HandlerArgTs...>::connect_bind_member(
+  m_handlers.push_back(m_dispatcher->connect_bind_member(
     signal, static_cast<DerivedT*>(this), handler, std::forward<BoundArgTs>(bound_args)...));
   return m_handlers.back();
 }
 
-template<typename DerivedT, typename SignalT, typename... HandlerArgTs>
+template<typename DerivedT, typename DispatcherT>
+template<typename... FwdHandlerArgTs>
+bool
+basic_handles<DerivedT, DispatcherT>::push_event(const signal_type& signal, FwdHandlerArgTs&&... args)
+{
+  return m_dispatcher->push_event(signal, std::forward<FwdHandlerArgTs>(args)...);
+}
+
+template<typename DerivedT, typename DispatcherT>
+template<typename... FwdHandlerArgTs>
+bool
+basic_handles<DerivedT, DispatcherT>::push_event(priority prio, const signal_type& signal, FwdHandlerArgTs&&... args)
+{
+  return m_dispatcher->push_event(prio, signal, std::forward<FwdHandlerArgTs>(args)...);
+}
+
+template<typename DerivedT, typename DispatcherT>
 template<typename... FwdHandlerArgTs>
 void
-handles<DerivedT, SignalT, HandlerArgTs...>::push_event(const SignalT& signal, FwdHandlerArgTs&&... args)
+basic_handles<DerivedT, DispatcherT>::emit(const signal_type& signal, FwdHandlerArgTs&&... args)
 {
-  dispatcher<SignalT, HandlerArgTs...>::push_event(signal, std::forward<FwdHandlerArgTs>(args)...);
+  m_dispatcher->emit(signal, std::forward<FwdHandlerArgTs>(args)...);
 }
 
-template<typename DerivedT, typename SignalT, typename... HandlerArgTs>
+template<typename DerivedT, typename DispatcherT>
 size_t
-handles<DerivedT, SignalT, HandlerArgTs...>::respond(size_t limit)
+basic_handles<DerivedT, DispatcherT>::respond(size_t limit)
 {
-  return dispatcher<SignalT, HandlerArgTs...>::respond(limit);
+  return m_dispatcher->respond(limit);
 }
 
-template<typename DerivedT, typename SignalT, typename... HandlerArgTs>
-handles<DerivedT, SignalT, HandlerArgTs...>::~handles()
+template<typename DerivedT, typename DispatcherT>
+DispatcherT&
+basic_handles<DerivedT, DispatcherT>::target() const
+{
+  return *m_dispatcher;
+}
+
+template<typename DerivedT, typename DispatcherT>
+basic_handles<DerivedT, DispatcherT>::~basic_handles()
 {
   for (auto& handle : m_handlers) {
-    dispatcher<SignalT, HandlerArgTs...>::disconnect(handle);
+    m_dispatcher->disconnect(handle);
   }
 }
 }
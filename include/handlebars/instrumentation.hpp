@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace handlebars {
+
+// a latency histogram in the style of HdrHistogram: every power of two is split into 16 linear sub-buckets, so a
+// recorded value is off by at most 1/16 (6.25%) while the whole range from 1ns to over a day fits in a few hundred
+// buckets. recording is a few relaxed atomic operations, so workers of a thread_pool can record concurrently.
+// copies are snapshots, taken with relaxed loads
+struct latency_histogram
+{
+  latency_histogram() = default;
+
+  latency_histogram(const latency_histogram& other) { assign(other); }
+
+  latency_histogram& operator=(const latency_histogram& other)
+  {
+    assign(other);
+    return *this;
+  }
+
+  void record(std::chrono::nanoseconds elapsed)
+  {
+    uint64_t value = (elapsed.count() > 0) ? static_cast<uint64_t>(elapsed.count()) : 0;
+    m_buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+  // the value below which percent of the recorded values are, rounded up to the end of its bucket
+  std::chrono::nanoseconds percentile(double percent) const
+  {
+    uint64_t total = count();
+    if (total == 0) {
+      return std::chrono::nanoseconds(0);
+    }
+    auto wanted = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(total) + 0.5);
+    wanted = (wanted == 0) ? 1 : (wanted > total ? total : wanted);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+      seen += m_buckets[bucket].load(std::memory_order_relaxed);
+      if (seen >= wanted) {
+        uint64_t highest = highest_value_of(bucket);
+        uint64_t max = m_max.load(std::memory_order_relaxed);
+        return std::chrono::nanoseconds(static_cast<int64_t>(highest < max ? highest : max));
+      }
+    }
+    return max();
+  }
+
+  std::chrono::nanoseconds mean() const
+  {
+    uint64_t total = count();
+    return std::chrono::nanoseconds(total == 0 ? 0 : static_cast<int64_t>(m_sum.load(std::memory_order_relaxed) / total));
+  }
+
+  std::chrono::nanoseconds max() const
+  {
+    return std::chrono::nanoseconds(static_cast<int64_t>(m_max.load(std::memory_order_relaxed)));
+  }
+
+  void reset()
+  {
+    for (auto& bucket : m_buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr unsigned sub_bucket_bits = 4;
+  static constexpr uint64_t sub_buckets = uint64_t(1) << sub_bucket_bits;
+  // values of 2^48ns (about 3 days) and above share the last bucket
+  static constexpr unsigned highest_exponent = 47;
+  static constexpr size_t bucket_count = sub_buckets + (highest_exponent - sub_bucket_bits + 1) * sub_buckets;
+
+  static unsigned floor_log2(uint64_t value)
+  {
+    unsigned exponent = 0;
+    for (unsigned step = 32; step > 0; step /= 2) {
+      if (value >> step) {
+        value >>= step;
+        exponent += step;
+      }
+    }
+    return exponent;
+  }
+
+  static size_t bucket_of(uint64_t value)
+  {
+    if (value < sub_buckets) {
+      return static_cast<size_t>(value);
+    }
+    unsigned exponent = floor_log2(value);
+    if (exponent > highest_exponent) {
+      return bucket_count - 1;
+    }
+    uint64_t sub_bucket = (value >> (exponent - sub_bucket_bits)) & (sub_buckets - 1);
+    return static_cast<size_t>(sub_buckets + (exponent - sub_bucket_bits) * sub_buckets + sub_bucket);
+  }
+
+  static uint64_t highest_value_of(size_t bucket)
+  {
+    if (bucket < sub_buckets) {
+      return bucket;
+    }
+    unsigned shift = static_cast<unsigned>((bucket - sub_buckets) / sub_buckets);
+    uint64_t sub_bucket = (bucket - sub_buckets) % sub_buckets;
+    return ((sub_buckets + sub_bucket + 1) << shift) - 1;
+  }
+
+  void assign(const latency_histogram& other)
+  {
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+      m_buckets[bucket].store(other.m_buckets[bucket].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    m_count.store(other.m_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_sum.store(other.m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_max.store(other.m_max.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+
+  std::array<std::atomic<uint64_t>, bucket_count> m_buckets{};
+  std::atomic<uint64_t> m_count{ 0 };
+  std::atomic<uint64_t> m_sum{ 0 };
+  std::atomic<uint64_t> m_max{ 0 };
+};
+
+inline namespace detail {
+
+// when an event was pushed, only stored by instrumented dispatchers
+template<bool Instrumented>
+struct push_stamp
+{
+  static push_stamp now() { return {}; }
+};
+
+template<>
+struct push_stamp<true>
+{
+  static push_stamp now() { return { std::chrono::steady_clock::now() }; }
+
+  std::chrono::steady_clock::time_point pushed_at{};
+};
+}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace handlebars {
+inline namespace detail {
+
+// a static interval tree over closed intervals [first, last] of an ordered KeyT, each carrying a ValueT.
+// intervals are sorted by first and the tree is implicit in that order (the middle of every range is its root), every
+// node knows the largest last of its subtree, so finding the intervals containing a key costs O(log n + matches).
+// built once with assign, there is no incremental insert
+template<typename KeyT, typename ValueT>
+struct interval_index
+{
+  struct interval
+  {
+    KeyT first;
+    KeyT last;
+    ValueT value;
+  };
+
+  void assign(std::vector<interval> intervals)
+  {
+    m_intervals = std::move(intervals);
+    std::sort(m_intervals.begin(), m_intervals.end(), [](const interval& lhs, const interval& rhs) {
+      return lhs.first < rhs.first;
+    });
+    m_max_last.resize(m_intervals.size());
+    if (!m_intervals.empty()) {
+      build(0, m_intervals.size());
+    }
+  }
+
+  bool empty() const { return m_intervals.empty(); }
+
+  // calls report(value) for every interval containing key
+  template<typename ReportT>
+  void query(const KeyT& key, ReportT&& report) const
+  {
+    query(0, m_intervals.size(), key, report);
+  }
+
+private:
+  // fills m_max_last for the subtree over [begin, end), returns the index of its largest last
+  size_t build(size_t begin, size_t end)
+  {
+    size_t middle = begin + (end - begin) / 2;
+    size_t largest = middle;
+    if (begin < middle) {
+      size_t left = build(begin, middle);
+      if (m_intervals[largest].last < m_intervals[left].last) {
+        largest = left;
+      }
+    }
+    if (middle + 1 < end) {
+      size_t right = build(middle + 1, end);
+      if (m_intervals[largest].last < m_intervals[right].last) {
+        largest = right;
+      }
+    }
+    m_max_last[middle] = largest;
+    return largest;
+  }
+
+  template<typename ReportT>
+  void query(size_t begin, size_t end, const KeyT& key, ReportT& report) const
+  {
+    while (begin < end) {
+      size_t middle = begin + (end - begin) / 2;
+      // nothing in this subtree reaches key
+      if (m_intervals[m_max_last[middle]].last < key) {
+        return;
+      }
+      query(begin, middle, key, report);
+      // the right subtree and the root only start at or after the root
+      if (key < m_intervals[middle].first) {
+        return;
+      }
+      if (!(m_intervals[middle].last < key)) {
+        report(m_intervals[middle].value);
+      }
+      begin = middle + 1;
+    }
+  }
+
+  std::vector<interval> m_intervals;
+  // the index of the interval with the largest last in the subtree rooted at every index
+  std::vector<size_t> m_max_last;
+};
+}
+}
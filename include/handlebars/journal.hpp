@@ -0,0 +1,415 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "symbol.hpp"
+
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HANDLEBARS_MMAP 1
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace handlebars {
+
+// a journal file starts with these 8 bytes, followed by records. a record is the size of its payload (uint32_t), the
+// time it was written in nanoseconds since the journal was opened (uint64_t) and the priority level of its event
+// (uint32_t), followed by the payload: the signal and then every argument, each written by its journal_codec.
+// numbers are in host byte order, a journal is meant to be replayed on the kind of machine that recorded it
+inline constexpr char journal_magic[8] = { 'h', 'b', 'j', 'o', 'u', 'r', 'n', '1' };
+
+// appends records to a journal file, which is memory mapped and grows in steps while it is written.
+// opening a file truncates it, closing it (or destroying the writer) cuts off the unused part of the mapping.
+// not synchronized, a journal is written by the responding thread of a dispatcher, see basic_dispatcher::record
+struct journal_writer
+{
+  // check is_open, a journal that could not be opened ignores what is written to it
+  explicit journal_writer(const std::string& path, size_t initial_capacity = size_t(1) << 20)
+    : m_opened(std::chrono::steady_clock::now())
+  {
+#ifdef HANDLEBARS_MMAP
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+      return;
+    }
+#else
+    m_path = path;
+#endif
+    if (!grow(std::max(initial_capacity, sizeof(journal_magic)))) {
+      close();
+      return;
+    }
+    write_bytes(journal_magic, sizeof(journal_magic));
+  }
+
+  journal_writer(const journal_writer&) = delete;
+  journal_writer& operator=(const journal_writer&) = delete;
+
+  ~journal_writer() { close(); }
+
+  bool is_open() const { return m_data != nullptr; }
+
+  // records written so far
+  size_t records() const { return m_records; }
+
+  // records left out because the journal could not grow to fit them
+  size_t dropped() const { return m_dropped; }
+
+  // bytes written so far, including the magic
+  size_t bytes() const { return m_size; }
+
+  // starts a record of an event queued at priority level, its payload follows through write_bytes
+  void begin_record(size_t level)
+  {
+    auto nanoseconds = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_opened).count());
+    auto level32 = static_cast<uint32_t>(level);
+    uint32_t size = 0;
+    m_record = m_size;
+    m_failed = false;
+    write_bytes(&size, sizeof(size));
+    write_bytes(&nanoseconds, sizeof(nanoseconds));
+    write_bytes(&level32, sizeof(level32));
+  }
+
+  // appends to the payload of the current record, used by journal_codec
+  void write_bytes(const void* data, size_t size)
+  {
+    if (m_data == nullptr || m_failed) {
+      return;
+    }
+    if (m_size + size > m_capacity && !grow(std::max(m_capacity * 2, m_size + size))) {
+      // the rest of the record is skipped as well, end_record drops it
+      m_failed = true;
+      return;
+    }
+    std::memcpy(m_data + m_size, data, size);
+    m_size += size;
+  }
+
+  // fills in the size of the current record, until then readers take it for the end of the journal.
+  // returns false if part of the record could not be written, the record is then dropped and the next one written
+  // in its place
+  bool end_record()
+  {
+    if (m_data == nullptr || m_failed) {
+      m_size = std::min(m_size, m_record);
+      m_failed = false;
+      ++m_dropped;
+      return false;
+    }
+    auto size = static_cast<uint32_t>(m_size - m_record - record_header_size);
+    std::memcpy(m_data + m_record, &size, sizeof(size));
+    ++m_records;
+    return true;
+  }
+
+  // writes what was appended so far to the file, blocking until it is done
+  void sync()
+  {
+#ifdef HANDLEBARS_MMAP
+    if (m_data != nullptr) {
+      ::msync(m_data, m_capacity, MS_SYNC);
+    }
+#endif
+  }
+
+  // unmaps the journal and truncates the file to the records written
+  void close()
+  {
+#ifdef HANDLEBARS_MMAP
+    if (m_data != nullptr) {
+      ::munmap(m_data, m_capacity);
+    }
+    if (m_fd >= 0) {
+      [[maybe_unused]] auto truncated = ::ftruncate(m_fd, static_cast<off_t>(m_size));
+      ::close(m_fd);
+      m_fd = -1;
+    }
+#else
+    if (m_data != nullptr) {
+      std::ofstream(m_path, std::ios::binary).write(reinterpret_cast<const char*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+  }
+
+  // size, time and level of a record
+  static constexpr size_t record_header_size = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
+private:
+  // maps capacity bytes of the file, which keeps what was written
+  bool grow(size_t capacity)
+  {
+#ifdef HANDLEBARS_MMAP
+    if (::ftruncate(m_fd, static_cast<off_t>(capacity)) != 0) {
+      return false;
+    }
+    if (m_data != nullptr) {
+      ::munmap(m_data, m_capacity);
+      m_data = nullptr;
+    }
+    void* mapped = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (mapped == MAP_FAILED) {
+      return false;
+    }
+    m_data = static_cast<unsigned char*>(mapped);
+#else
+    m_buffer.resize(capacity);
+    m_data = m_buffer.data();
+#endif
+    m_capacity = capacity;
+    return true;
+  }
+
+  std::chrono::steady_clock::time_point m_opened;
+  unsigned char* m_data = nullptr;
+  size_t m_capacity = 0;
+  size_t m_size = 0;
+  // where the current record starts
+  size_t m_record = 0;
+  size_t m_records = 0;
+  size_t m_dropped = 0;
+  // set when a write of the current record did not fit
+  bool m_failed = false;
+#ifdef HANDLEBARS_MMAP
+  int m_fd = -1;
+#else
+  std::string m_path;
+  std::vector<unsigned char> m_buffer;
+#endif
+};
+
+// reads the records of a journal file, which is mapped as a whole
+struct journal_reader
+{
+  // check is_open, a missing file or one without the journal magic reads as empty
+  explicit journal_reader(const std::string& path)
+  {
+#ifdef HANDLEBARS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(journal_magic)) {
+      void* mapped = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED) {
+        m_data = static_cast<const unsigned char*>(mapped);
+        m_size = static_cast<size_t>(info.st_size);
+      }
+    }
+    ::close(fd);
+#else
+    std::ifstream file(path, std::ios::binary);
+    m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+    if (m_data != nullptr && (m_size < sizeof(journal_magic) ||
+                              std::memcmp(m_data, journal_magic, sizeof(journal_magic)) != 0)) {
+      unmap();
+    }
+    rewind();
+  }
+
+  journal_reader(const journal_reader&) = delete;
+  journal_reader& operator=(const journal_reader&) = delete;
+
+  ~journal_reader() { unmap(); }
+
+  bool is_open() const { return m_data != nullptr; }
+
+  // size of the file
+  size_t bytes() const { return m_size; }
+
+  // moves to the next record, false at the end of the journal or if the rest of it is cut off
+  bool next()
+  {
+    if (m_data == nullptr || m_end + journal_writer::record_header_size > m_size) {
+      return false;
+    }
+    uint32_t size;
+    std::memcpy(&size, m_data + m_end, sizeof(size));
+    std::memcpy(&m_timestamp, m_data + m_end + sizeof(size), sizeof(m_timestamp));
+    std::memcpy(&m_level, m_data + m_end + sizeof(size) + sizeof(m_timestamp), sizeof(m_level));
+    size_t begin = m_end + journal_writer::record_header_size;
+    // a payload holds at least the signal, size 0 is a record that was never finished or the unused end of a
+    // journal whose writer was not closed
+    if (size == 0 || begin + size > m_size) {
+      return false;
+    }
+    m_position = begin;
+    m_end = begin + size;
+    return true;
+  }
+
+  // back to before the first record
+  void rewind()
+  {
+    m_position = m_end = sizeof(journal_magic);
+    m_timestamp = 0;
+    m_level = 0;
+  }
+
+  // when the current record was written, since the journal was opened for writing
+  std::chrono::nanoseconds timestamp() const { return std::chrono::nanoseconds(m_timestamp); }
+
+  // priority level of the current record
+  size_t level() const { return m_level; }
+
+  // bytes of the current record payload not read yet
+  size_t remaining() const { return m_end - m_position; }
+
+  // reads from the payload of the current record, used by journal_codec.
+  // returns false and zeroes data if the payload is shorter than that
+  bool read_bytes(void* data, size_t size)
+  {
+    if (m_position + size > m_end) {
+      std::memset(data, 0, size);
+      return false;
+    }
+    std::memcpy(data, m_data + m_position, size);
+    m_position += size;
+    return true;
+  }
+
+private:
+  void unmap()
+  {
+#ifdef HANDLEBARS_MMAP
+    if (m_data != nullptr) {
+      ::munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+  }
+
+  const unsigned char* m_data = nullptr;
+  size_t m_size = 0;
+  // read position and end of the payload of the current record
+  size_t m_position = 0;
+  size_t m_end = 0;
+  uint64_t m_timestamp = 0;
+  uint32_t m_level = 0;
+#ifndef HANDLEBARS_MMAP
+  std::vector<unsigned char> m_buffer;
+#endif
+};
+
+// how signals and arguments of type T are written to a journal and read back for replay.
+// trivially copyable types are copied byte for byte, specialize this for anything else (see the ones below).
+// write appends the value with out.write_bytes, read returns the value made from in.read_bytes
+template<typename T, typename = void>
+struct journal_codec
+{
+  static_assert(std::is_trivially_copyable_v<T>, "specialize handlebars::journal_codec for this type");
+  static_assert(!std::is_pointer_v<T>, "a pointer does not survive a journal, specialize handlebars::journal_codec");
+
+  static void write(journal_writer& out, const T& value) { out.write_bytes(&value, sizeof(T)); }
+
+  static T read(journal_reader& in)
+  {
+    T value;
+    in.read_bytes(&value, sizeof(T));
+    return value;
+  }
+};
+
+// the length followed by the characters
+template<>
+struct journal_codec<std::string>
+{
+  static void write(journal_writer& out, const std::string& value)
+  {
+    auto size = static_cast<uint32_t>(value.size());
+    out.write_bytes(&size, sizeof(size));
+    out.write_bytes(value.data(), size);
+  }
+
+  static std::string read(journal_reader& in)
+  {
+    uint32_t size = 0;
+    in.read_bytes(&size, sizeof(size));
+    if (size > in.remaining()) {
+      return {};
+    }
+    std::string value(size, '\0');
+    in.read_bytes(value.data(), size);
+    return value;
+  }
+};
+
+// the length followed by every element
+template<typename T>
+struct journal_codec<std::vector<T>>
+{
+  static void write(journal_writer& out, const std::vector<T>& value)
+  {
+    auto size = static_cast<uint32_t>(value.size());
+    out.write_bytes(&size, sizeof(size));
+    for (auto& element : value) {
+      journal_codec<T>::write(out, element);
+    }
+  }
+
+  static std::vector<T> read(journal_reader& in)
+  {
+    uint32_t size = 0;
+    in.read_bytes(&size, sizeof(size));
+    std::vector<T> value;
+    // every element takes at least a byte, which bounds the size of a cut off record
+    for (uint32_t i = 0; i < size && in.remaining() > 0; ++i) {
+      value.push_back(journal_codec<T>::read(in));
+    }
+    return value;
+  }
+};
+
+// symbol ids depend on the order names were interned in, so the name is written and interned again on replay
+template<>
+struct journal_codec<symbol>
+{
+  static void write(journal_writer& out, const symbol& value)
+  {
+    journal_codec<std::string>::write(out, std::string(value.name()));
+  }
+
+  static symbol read(journal_reader& in) { return symbol(journal_codec<std::string>::read(in)); }
+};
+
+// how basic_dispatcher::replay paces the events of a journal
+enum class replay_timing
+{
+  // events are pushed in batches and responded to as fast as the handlers allow
+  as_fast_as_possible,
+  // every event is pushed and responded to as long after the first one as it was recorded
+  original
+};
+
+// what basic_dispatcher::replay did
+struct replay_stats
+{
+  size_t events = 0;
+  std::chrono::steady_clock::duration elapsed{};
+
+  double events_per_second() const
+  {
+    auto seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? static_cast<double>(events) / seconds : 0.0;
+  }
+};
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+namespace handlebars {
+inline namespace detail {
+
+// unbounded multi producer, single consumer queue (intrusive node design by Dmitry Vyukov).
+// a push is one atomic exchange and one store, producers never wait on each other or on the consumer.
+// only one thread at a time may call try_pop/drain
+template<typename T>
+struct mpsc_queue
+{
+private:
+  struct node;
+
+public:
+  mpsc_queue()
+    : m_head{ &m_stub }
+    , m_tail{ &m_stub }
+  {}
+  mpsc_queue(const mpsc_queue&) = delete;
+  mpsc_queue& operator=(const mpsc_queue&) = delete;
+  ~mpsc_queue()
+  {
+    drain([](T&&) {});
+    if (m_tail != &m_stub) {
+      delete m_tail;
+    }
+  }
+
+  // safe to call from any thread
+  template<typename... ArgTs>
+  void push(ArgTs&&... args)
+  {
+    node* n = new node{ std::forward<ArgTs>(args)... };
+    m_size.fetch_add(1, std::memory_order_relaxed);
+    node* prev = m_head.exchange(n, std::memory_order_acq_rel);
+    prev->next.store(n, std::memory_order_release);
+  }
+
+  // items linked up front by a single producer, so push_batch can hand all of them over at once
+  struct batch
+  {
+    batch() = default;
+    batch(const batch&) = delete;
+    batch& operator=(const batch&) = delete;
+    ~batch()
+    {
+      while (m_first != nullptr) {
+        node* n = m_first;
+        m_first = n->next.load(std::memory_order_relaxed);
+        delete n;
+      }
+    }
+
+    template<typename... ArgTs>
+    void push(ArgTs&&... args)
+    {
+      node* n = new node{ std::forward<ArgTs>(args)... };
+      if (m_last != nullptr) {
+        m_last->next.store(n, std::memory_order_relaxed);
+      } else {
+        m_first = n;
+      }
+      m_last = n;
+      ++m_size;
+    }
+
+    size_t size() const { return m_size; }
+
+  private:
+    friend mpsc_queue;
+    node* m_first = nullptr;
+    node* m_last = nullptr;
+    size_t m_size = 0;
+  };
+
+  // safe to call from any thread. the items of items become visible together and in order, for one atomic exchange.
+  // leaves items empty
+  void push_batch(batch& items)
+  {
+    if (items.m_first == nullptr) {
+      return;
+    }
+    m_size.fetch_add(items.m_size, std::memory_order_relaxed);
+    node* prev = m_head.exchange(items.m_last, std::memory_order_acq_rel);
+    prev->next.store(items.m_first, std::memory_order_release);
+    items.m_first = items.m_last = nullptr;
+    items.m_size = 0;
+  }
+
+  // consumer only. an item whose push has not fully completed yet is left for the next call
+  std::optional<T> try_pop()
+  {
+    node* tail = m_tail;
+    node* next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return std::nullopt;
+    }
+    m_tail = next;
+    std::optional<T> value{ std::move(next->value) };
+    next->value.reset(); // "next" becomes the new stub
+    if (tail != &m_stub) {
+      delete tail;
+    }
+    m_size.fetch_sub(1, std::memory_order_relaxed);
+    return value;
+  }
+
+  // consumer only. moves every available item into sink, returns how many were moved
+  template<typename SinkT>
+  size_t drain(SinkT&& sink)
+  {
+    size_t count = 0;
+    node* tail = m_tail;
+    node* next = tail->next.load(std::memory_order_acquire);
+    while (next != nullptr) {
+      sink(std::move(*next->value));
+      next->value.reset();
+      if (tail != &m_stub) {
+        delete tail;
+      }
+      tail = next;
+      next = tail->next.load(std::memory_order_acquire);
+      ++count;
+    }
+    m_tail = tail;
+    if (count > 0) {
+      m_size.fetch_sub(count, std::memory_order_relaxed);
+    }
+    return count;
+  }
+
+  // approximate while producers are active
+  size_t size() const { return m_size.load(std::memory_order_relaxed); }
+
+private:
+  struct node
+  {
+    node() = default;
+    template<typename... ArgTs>
+    explicit node(ArgTs&&... args)
+      : value{ std::in_place, std::forward<ArgTs>(args)... }
+    {}
+
+    std::atomic<node*> next{ nullptr };
+    std::optional<T> value;
+  };
+
+  // producers only touch this cache line, the consumer only touches m_tail
+  alignas(64) std::atomic<node*> m_head;
+  std::atomic<size_t> m_size{ 0 };
+  alignas(64) node* m_tail;
+  node m_stub;
+};
+}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+
+namespace handlebars::policy {
+
+// policies configure how a dispatcher stores and hands over its events.
+// every policy derives from "defaults" so a policy only has to spell out the values it changes,
+// and policies can be stacked like: policy::concurrent<policy::defaults>
+
+// what push_event does when the queue of a bounded policy is full
+enum class overflow
+{
+  // push_event returns false, the new event is discarded
+  reject,
+  // push_event waits until respond has made room, only with concurrent producers
+  block,
+  // the oldest pending event is discarded to make room for the new one
+  drop_oldest,
+  // the newest pending event is discarded to make room for the new one
+  drop_newest,
+  // the new event replaces the newest pending event with the same signal, it is rejected if there is none
+  coalesce
+};
+
+// the default policy: events are pushed and responded to from the same thread (or under the users own lock)
+struct defaults
+{
+  // when true, any number of threads may call push_event concurrently while a single thread calls respond
+  static constexpr bool concurrent_producers = false;
+  // when not 0, events are allocated from an arena of this many bytes which is reset whenever respond empties the queue
+  static constexpr size_t arena_bytes = 0;
+  // when not 0, at most this many events can be pending, what happens to more is decided by "overflow_action"
+  static constexpr size_t capacity = 0;
+  static constexpr overflow overflow_action = overflow::reject;
+  // when greater than 1, events can be pushed with a priority below this, respond handles higher priorities first
+  static constexpr size_t priority_levels = 1;
+  // when true, the dispatcher keeps statistics about signals, queue latency and handler run time
+  static constexpr bool collect_statistics = false;
+};
+
+// many producer threads push events through a lock-free queue, a single consumer thread responds.
+// connect and disconnect are not synchronized, call them from the consumer thread or before producers start
+template<typename BasePolicyT = defaults>
+struct concurrent : BasePolicyT
+{
+  static constexpr bool concurrent_producers = true;
+};
+
+// events and their arguments are allocated from a monotonic arena of Bytes which is handed back in one go whenever
+// respond leaves the queue empty, instead of allocating and freeing every event on its own.
+// arguments of pmr-aware types such as std::pmr::string are constructed with the arena too. handlers must not keep
+// such arguments (or moves of them) beyond the event, and a queue that never becomes empty never resets its arena.
+// not available together with concurrent producers
+template<size_t Bytes = 64 * 1024, typename BasePolicyT = defaults>
+struct arena : BasePolicyT
+{
+  static_assert(Bytes > 0, "an arena needs some space");
+  static constexpr size_t arena_bytes = Bytes;
+};
+
+// bounds the queue to Capacity pending events, so memory stays bounded when producers outrun respond.
+// Action picks what happens to events pushed while the queue is full, see "overflow".
+// with concurrent producers only overflow::reject and overflow::block are available, since the other actions need to
+// modify events that are already queued
+template<size_t Capacity, overflow Action = overflow::reject, typename BasePolicyT = defaults>
+struct bounded : BasePolicyT
+{
+  static_assert(Capacity > 0, "a bounded queue needs room for at least one event");
+  static constexpr size_t capacity = Capacity;
+  static constexpr overflow overflow_action = Action;
+};
+
+// events are pushed with a priority from 0 (the default) to Levels - 1, respond always handles pending events of the
+// highest priority first and events of the same priority in the order they were pushed.
+// every priority has its own queue, so pushing stays O(1) and finding the next event costs at most Levels checks.
+// a bounded queue counts events of all priorities, and can only reject or block when full
+template<size_t Levels, typename BasePolicyT = defaults>
+struct prioritized : BasePolicyT
+{
+  static_assert(Levels > 1, "priorities need at least two levels");
+  static constexpr size_t priority_levels = Levels;
+};
+
+// the dispatcher records per signal how many events were pushed and handled, how long events waited in the queue, how
+// long every handler ran and the highest number of pending events, see basic_dispatcher::statistics().
+// costs two clock reads per event plus one per handler, nothing at all without this policy
+template<typename BasePolicyT = defaults>
+struct instrumented : BasePolicyT
+{
+  static constexpr bool collect_statistics = true;
+};
+}
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "dispatcher.hpp"
+
+namespace handlebars {
+
+// a dispatcher split into shards, each a concurrent basic_dispatcher with its own queue and handlers and drained by
+// its own consumer thread. a signal always belongs to the same shard, picked by a partition function of the signal
+// (std::hash by default), so events of one signal are handled in the order they were pushed while different shards
+// respond at the same time. connect and disconnect land in the shard of their signal, like basic_handles does.
+// push_event may be called from any thread, handlers must not assume they run on a particular thread.
+// connect and disconnect are not synchronized with the consumer threads, call them before start or after stop
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+struct basic_sharded_dispatcher
+{
+  using shard_type = basic_dispatcher<policy::concurrent<PolicyT>, SignalT, HandlerArgTs...>;
+  using signal_type = SignalT;
+  using handler_id_type = typename shard_type::handler_id_type;
+  using partition_type = tmf::callable<size_t(const SignalT&)>;
+
+  // shards is clamped to at least one
+  explicit basic_sharded_dispatcher(size_t shards = std::thread::hardware_concurrency(),
+                                    partition_type partition = [](const SignalT& signal) {
+                                      return std::hash<SignalT>{}(signal);
+                                    });
+  basic_sharded_dispatcher(const basic_sharded_dispatcher&) = delete;
+  basic_sharded_dispatcher& operator=(const basic_sharded_dispatcher&) = delete;
+
+  // stops the consumer threads, see stop
+  ~basic_sharded_dispatcher();
+
+  // see basic_dispatcher, these forward to the shard of signal
+  template<typename HandlerT>
+  handler_id_type connect(const SignalT& signal, HandlerT&& handler);
+
+  template<typename HandlerT, typename... BoundArgTs>
+  handler_id_type connect_bind(const SignalT& signal, HandlerT&& handler, BoundArgTs&&... bound_args);
+
+  template<typename ClassT, typename MemPtrT>
+  handler_id_type connect_member(const SignalT& signal, ClassT&& object, MemPtrT member);
+
+  template<typename ClassT, typename MemPtrT, typename... BoundArgTs>
+  handler_id_type connect_bind_member(const SignalT& signal, ClassT&& object, MemPtrT member, BoundArgTs&&... bound_args);
+
+  bool disconnect(const handler_id_type& handler_id);
+
+  template<typename... FwdHandlerArgTs>
+  bool push_event(const SignalT& signal, FwdHandlerArgTs&&... args);
+
+  template<typename... FwdHandlerArgTs>
+  bool push_event(priority prio, const SignalT& signal, FwdHandlerArgTs&&... args);
+
+  template<typename RangeT>
+  size_t push_events(const SignalT& signal, RangeT&& range);
+
+  // starts one consumer thread per shard, which sleep in wait_and_respond while their shard has nothing to do
+  void start();
+
+  // wakes and joins the consumer threads. events still pending stay queued, respond can handle them
+  void stop();
+
+  // responds to every shard in turn on the calling thread, for when the consumer threads are not running.
+  // limit applies to each shard
+  size_t respond(size_t limit = 0);
+
+  // approximate while producers are active, and like respond only while the consumer threads are not running
+  size_t events_pending() const;
+
+  size_t shard_count() const;
+
+  // the index of the shard signal belongs to
+  size_t shard_of(const SignalT& signal) const;
+
+  // a shard, to drive it with threads of your own instead of start()
+  shard_type& shard(size_t index);
+
+private:
+  shard_type& shard_for(const SignalT& signal);
+
+  partition_type m_partition;
+  std::vector<std::unique_ptr<shard_type>> m_shards;
+  std::vector<std::thread> m_consumers;
+  std::atomic<bool> m_stopping{ false };
+};
+
+// sharded dispatcher with the default policy
+template<typename SignalT, typename... HandlerArgTs>
+using sharded_dispatcher = basic_sharded_dispatcher<policy::defaults, SignalT, HandlerArgTs...>;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////Implementation//////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::basic_sharded_dispatcher(size_t shards,
+                                                                                       partition_type partition)
+  : m_partition(std::move(partition))
+{
+  shards = std::max<size_t>(shards, 1);
+  for (size_t i = 0; i < shards; ++i) {
+    m_shards.push_back(std::make_unique<shard_type>());
+  }
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::~basic_sharded_dispatcher()
+{
+  stop();
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+template<typename HandlerT>
+typename basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect(const SignalT& signal, HandlerT&& handler)
+{
+  return shard_for(signal).connect(signal, std::forward<HandlerT>(handler));
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+template<typename HandlerT, typename... BoundArgTs>
+typename basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_bind(const SignalT& signal,
+                                                                          HandlerT&& handler,
+                                                                          BoundArgTs&&... bound_args)
+{
+  return shard_for(signal).connect_bind(
+    signal, std::forward<HandlerT>(handler), std::forward<BoundArgTs>(bound_args)...);
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+template<typename ClassT, typename MemPtrT>
+typename basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_member(const SignalT& signal,
+                                                                            ClassT&& object,
+                                                                            MemPtrT member)
+{
+  return shard_for(signal).connect_member(signal, std::forward<ClassT>(object), member);
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+template<typename ClassT, typename MemPtrT, typename... BoundArgTs>
+typename basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::handler_id_type
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::connect_bind_member(const SignalT& signal,
+                                                                                 ClassT&& object,
+                                                                                 MemPtrT member,
+                                                                                 BoundArgTs&&... bound_args)
+{
+  return shard_for(signal).connect_bind_member(
+    signal, std::forward<ClassT>(object), member, std::forward<BoundArgTs>(bound_args)...);
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+bool
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::disconnect(const handler_id_type& handler_id)
+{
+  // ids carry their signal, which leads back to the shard
+  return shard_for(handler_id.signal).disconnect(handler_id);
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+template<typename... FwdHandlerArgTs>
+bool
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event(const SignalT& signal,
+                                                                        FwdHandlerArgTs&&... args)
+{
+  return shard_for(signal).push_event(signal, std::forward<FwdHandlerArgTs>(args)...);
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+template<typename... FwdHandlerArgTs>
+bool
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_event(priority prio,
+                                                                        const SignalT& signal,
+                                                                        FwdHandlerArgTs&&... args)
+{
+  return shard_for(signal).push_event(prio, signal, std::forward<FwdHandlerArgTs>(args)...);
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+template<typename RangeT>
+size_t
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::push_events(const SignalT& signal, RangeT&& range)
+{
+  return shard_for(signal).push_events(signal, std::forward<RangeT>(range));
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+void
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::start()
+{
+  if (!m_consumers.empty()) {
+    return;
+  }
+  m_stopping.store(false, std::memory_order_relaxed);
+  for (auto& shard : m_shards) {
+    m_consumers.emplace_back([this, consumer = shard.get()] {
+      while (!m_stopping.load(std::memory_order_acquire)) {
+        consumer->wait_and_respond(std::chrono::seconds(1));
+      }
+    });
+  }
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+void
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::stop()
+{
+  if (m_consumers.empty()) {
+    // a wake nobody waits for would cut short the next wait_and_respond on the shard
+    return;
+  }
+  m_stopping.store(true, std::memory_order_release);
+  for (auto& shard : m_shards) {
+    shard->wake();
+  }
+  for (auto& consumer : m_consumers) {
+    consumer.join();
+  }
+  m_consumers.clear();
+  // a consumer may have stopped without taking its wake, which would cut short the next wait_and_respond
+  for (auto& shard : m_shards) {
+    shard->clear_wake();
+  }
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+size_t
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::respond(size_t limit)
+{
+  size_t handled = 0;
+  for (auto& shard : m_shards) {
+    handled += shard->respond(limit);
+  }
+  return handled;
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+size_t
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::events_pending() const
+{
+  size_t pending = 0;
+  for (auto& shard : m_shards) {
+    pending += shard->events_pending();
+  }
+  return pending;
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+size_t
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::shard_count() const
+{
+  return m_shards.size();
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+size_t
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::shard_of(const SignalT& signal) const
+{
+  return m_partition(signal) % m_shards.size();
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+typename basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::shard_type&
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::shard(size_t index)
+{
+  return *m_shards[index];
+}
+
+template<typename PolicyT, typename SignalT, typename... HandlerArgTs>
+typename basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::shard_type&
+basic_sharded_dispatcher<PolicyT, SignalT, HandlerArgTs...>::shard_for(const SignalT& signal)
+{
+  return *m_shards[shard_of(signal)];
+}
+}
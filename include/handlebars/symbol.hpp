@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace handlebars {
+
+// maps names to compact ids once, so signals named by strings can be stored, compared and hashed as integers.
+// names are never removed, interning is serialized and lookups of names and ids may run on any thread
+struct symbol_table
+{
+  symbol_table() { intern(""); }
+
+  symbol_table(const symbol_table&) = delete;
+  symbol_table& operator=(const symbol_table&) = delete;
+
+  // the table symbols are interned into
+  static symbol_table& global()
+  {
+    static symbol_table table;
+    return table;
+  }
+
+  // the id of name, which is added to the table if it is new
+  uint32_t intern(std::string_view name)
+  {
+    {
+      std::shared_lock lock(m_lock);
+      auto found = m_ids.find(name);
+      if (found != m_ids.end()) {
+        return found->second;
+      }
+    }
+    std::unique_lock lock(m_lock);
+    auto found = m_ids.find(name);
+    if (found != m_ids.end()) {
+      return found->second;
+    }
+    auto id = static_cast<uint32_t>(m_names.size());
+    // a deque never moves its strings, so the views used as keys stay valid
+    m_names.emplace_back(name);
+    m_ids.emplace(m_names.back(), id);
+    return id;
+  }
+
+  // the id of name, without adding it
+  std::optional<uint32_t> find(std::string_view name) const
+  {
+    std::shared_lock lock(m_lock);
+    auto found = m_ids.find(name);
+    if (found == m_ids.end()) {
+      return std::nullopt;
+    }
+    return found->second;
+  }
+
+  // the name of id, which must have been returned by this table. stays valid as long as the table
+  std::string_view name(uint32_t id) const
+  {
+    std::shared_lock lock(m_lock);
+    return m_names[id];
+  }
+
+  size_t size() const
+  {
+    std::shared_lock lock(m_lock);
+    return m_names.size();
+  }
+
+private:
+  mutable std::shared_mutex m_lock;
+  std::deque<std::string> m_names;
+  std::unordered_map<std::string_view, uint32_t> m_ids;
+};
+
+// a signal named by a string but handled like an integer: the name is interned into symbol_table::global() once,
+// after that symbols are copied, compared and hashed by their id. constructing a symbol from a string only hashes it
+// when the name is known already, so pushing events allocates no strings.
+// strings convert implicitly, so a dispatcher keyed by symbols is used just like one keyed by std::string
+struct symbol
+{
+  // the empty name
+  symbol() = default;
+
+  symbol(std::string_view name)
+    : m_id(symbol_table::global().intern(name))
+  {}
+
+  symbol(const char* name)
+    : symbol(std::string_view(name))
+  {}
+
+  symbol(const std::string& name)
+    : symbol(std::string_view(name))
+  {}
+
+  // the symbol of name if it was interned before, to look up untrusted input without growing the table
+  static std::optional<symbol> find(std::string_view name)
+  {
+    auto id = symbol_table::global().find(name);
+    if (!id) {
+      return std::nullopt;
+    }
+    return from_id(*id);
+  }
+
+  static symbol from_id(uint32_t id)
+  {
+    symbol result;
+    result.m_id = id;
+    return result;
+  }
+
+  uint32_t id() const { return m_id; }
+
+  std::string_view name() const { return symbol_table::global().name(m_id); }
+
+  friend bool operator==(const symbol& lhs, const symbol& rhs) { return lhs.m_id == rhs.m_id; }
+  friend bool operator!=(const symbol& lhs, const symbol& rhs) { return lhs.m_id != rhs.m_id; }
+  // orders by id, which is the order names were first interned in
+  friend bool operator<(const symbol& lhs, const symbol& rhs) { return lhs.m_id < rhs.m_id; }
+
+private:
+  uint32_t m_id = 0;
+};
+}
+
+namespace std {
+template<>
+struct hash<handlebars::symbol>
+{
+  size_t operator()(const handlebars::symbol& s) const noexcept { return s.id(); }
+};
+}
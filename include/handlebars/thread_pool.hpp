@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace handlebars {
+
+// a fixed size work-stealing thread pool, used by basic_dispatcher::respond(thread_pool&, ...).
+// work is submitted in batches of indexed tasks: each worker has its own task queue, takes its own tasks
+// newest first and steals the oldest tasks of other workers when it runs dry.
+// the thread which submits a batch helps executing it until the whole batch is done
+struct thread_pool
+{
+  // starts "threads" workers, at least one
+  explicit thread_pool(size_t threads = std::thread::hardware_concurrency());
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  // joins all workers, batches must not be running
+  ~thread_pool();
+
+  // amount of worker threads
+  size_t size() const;
+
+  // calls task(i) for every i in [0, count) on the workers and the calling thread.
+  // returns once every call has returned. tasks of one batch may run in any order and concurrently
+  template<typename TaskT>
+  void run(size_t count, TaskT&& task);
+
+private:
+  struct batch
+  {
+    void (*invoke)(void* task, size_t index);
+    void* task;
+    std::atomic<size_t> remaining;
+  };
+
+  struct work_item
+  {
+    batch* owner;
+    size_t index;
+  };
+
+  struct alignas(64) worker_queue
+  {
+    std::mutex lock;
+    std::deque<work_item> items;
+  };
+
+  // pops from the back of queue "preferred", otherwise steals from the front of any other queue
+  bool take(size_t preferred, work_item& item);
+  void execute(const work_item& item);
+  void worker_loop(size_t index);
+
+  std::vector<std::unique_ptr<worker_queue>> m_queues;
+  std::vector<std::thread> m_threads;
+  std::mutex m_sleep_lock;
+  std::condition_variable m_wake;
+  std::atomic<size_t> m_queued{ 0 };
+  bool m_stopping = false;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////Implementation//////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline thread_pool::thread_pool(size_t threads)
+{
+  threads = std::max<size_t>(threads, 1);
+  for (size_t i = 0; i < threads; ++i) {
+    m_queues.push_back(std::make_unique<worker_queue>());
+  }
+  for (size_t i = 0; i < threads; ++i) {
+    m_threads.emplace_back(&thread_pool::worker_loop, this, i);
+  }
+}
+
+inline thread_pool::~thread_pool()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_sleep_lock);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  for (auto& t : m_threads) {
+    t.join();
+  }
+}
+
+inline size_t
+thread_pool::size() const
+{
+  return m_threads.size();
+}
+
+template<typename TaskT>
+void
+thread_pool::run(size_t count, TaskT&& task)
+{
+  if (count == 0) {
+    return;
+  }
+  batch work{ [](void* t, size_t index) { (*static_cast<std::remove_reference_t<TaskT>*>(t))(index); },
+              const_cast<void*>(static_cast<const void*>(std::addressof(task))),
+              { count } };
+
+  {
+    std::lock_guard<std::mutex> guard(m_sleep_lock);
+    m_queued.fetch_add(count, std::memory_order_release);
+  }
+  // deal tasks out round robin, stealing evens out whatever imbalance that leaves
+  for (size_t q = 0; q < m_queues.size(); ++q) {
+    std::lock_guard<std::mutex> guard(m_queues[q]->lock);
+    for (size_t index = q; index < count; index += m_queues.size()) {
+      m_queues[q]->items.push_back({ &work, index });
+    }
+  }
+  m_wake.notify_all();
+
+  // help out instead of blocking, then wait for tasks still running elsewhere
+  work_item item;
+  size_t start = 0;
+  while (work.remaining.load(std::memory_order_acquire) > 0) {
+    if (take(start++ % m_queues.size(), item)) {
+      execute(item);
+    }
+    else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+inline bool
+thread_pool::take(size_t preferred, work_item& item)
+{
+  {
+    auto& own = *m_queues[preferred];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (!own.items.empty()) {
+      item = own.items.back();
+      own.items.pop_back();
+      m_queued.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  for (size_t offset = 1; offset < m_queues.size(); ++offset) {
+    auto& victim = *m_queues[(preferred + offset) % m_queues.size()];
+    std::lock_guard<std::mutex> guard(victim.lock);
+    if (!victim.items.empty()) {
+      item = victim.items.front();
+      victim.items.pop_front();
+      m_queued.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void
+thread_pool::execute(const work_item& item)
+{
+  item.owner->invoke(item.owner->task, item.index);
+  item.owner->remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+inline void
+thread_pool::worker_loop(size_t index)
+{
+  work_item item;
+  while (true) {
+    if (take(index, item)) {
+      execute(item);
+      continue;
+    }
+    std::unique_lock<std::mutex> guard(m_sleep_lock);
+    m_wake.wait(guard, [this] { return m_stopping || m_queued.load(std::memory_order_acquire) > 0; });
+    if (m_stopping) {
+      return;
+    }
+  }
+}
+}
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace handlebars {
+inline namespace detail {
+
+// a hierarchical timer wheel: four levels of 64 slots, each slot of a level spans all 64 slots of the level below.
+// a timer is put into the slot of the lowest level that reaches its due tick, and moved down a level whenever time
+// reaches its slot, so scheduling and expiring a timer is O(1) amortized however many timers are pending.
+// timers further away than the top level can reach wait in its last slot and are placed again when it comes up.
+// cancelled timers are only marked, their nodes are reused once time reaches their slot
+template<typename T>
+struct timer_wheel
+{
+  using clock_type = std::chrono::steady_clock;
+
+  // identifies a scheduled timer, stays unique after the timer expired or was cancelled
+  struct id_type
+  {
+    uint32_t index = static_cast<uint32_t>(-1);
+    uint32_t generation = 0;
+  };
+
+  explicit timer_wheel(clock_type::duration tick = std::chrono::milliseconds(1),
+                       clock_type::time_point start = clock_type::now())
+    : m_tick(tick)
+    , m_start(start)
+  {}
+
+  // item is handed out once due, and then every period if period is not zero, which needs a copyable T.
+  // items are never handed out early, but up to one tick late. periods missed while time was not advanced are skipped
+  id_type schedule(clock_type::time_point due, T item, clock_type::duration period = clock_type::duration::zero())
+  {
+    uint32_t index;
+    if (m_free.empty()) {
+      index = static_cast<uint32_t>(m_nodes.size());
+      m_nodes.emplace_back();
+    } else {
+      index = m_free.back();
+      m_free.pop_back();
+    }
+    auto& n = m_nodes[index];
+    n.item.emplace(std::move(item));
+    n.due = ticks_until(due);
+    n.period = (period > clock_type::duration::zero()) ? std::max<uint64_t>(ticks_until(m_start + period), 1) : 0;
+    ++m_size;
+    if (n.due <= m_current) {
+      m_expired.push_back(index);
+    } else {
+      place(index);
+    }
+    return { index, n.generation };
+  }
+
+  // false if the timer already expired or was cancelled
+  bool cancel(const id_type& id)
+  {
+    if (id.index >= m_nodes.size() || m_nodes[id.index].generation != id.generation || !m_nodes[id.index].item) {
+      return false;
+    }
+    m_nodes[id.index].item.reset();
+    --m_size;
+    return true;
+  }
+
+  // moves time forward to now, sink(T&&) is called for every item that became due, in order of their due ticks.
+  // returns how many items were handed out
+  template<typename SinkT>
+  size_t advance(clock_type::time_point now, SinkT&& sink)
+  {
+    size_t fired = 0;
+    if (!m_expired.empty()) {
+      std::vector<uint32_t> expired;
+      expired.swap(m_expired);
+      fired += fire(expired, sink);
+    }
+    uint64_t target = (now > m_start) ? static_cast<uint64_t>((now - m_start) / m_tick) : 0;
+    while (m_current < target) {
+      if (m_size == 0) {
+        // nothing to hand out, time can jump
+        m_current = target;
+        break;
+      }
+      // skips empty slots of the lowest level up to the next one with timers, or the next cascade
+      size_t offset = static_cast<size_t>(m_current & slot_mask);
+      size_t slot = offset + 1;
+      while (slot < slots && m_levels[0][slot].empty()) {
+        ++slot;
+      }
+      uint64_t next = m_current - offset + slot;
+      if (next > target) {
+        m_current = target;
+        break;
+      }
+      m_current = next;
+      if (slot == slots) {
+        cascade();
+      }
+      fired += fire_slot(static_cast<size_t>(m_current & slot_mask), sink);
+    }
+    return fired;
+  }
+
+  // the earliest time advance may hand out an item, time_point::max() without timers. may be earlier than the first
+  // due timer when timers of an upper level are about to move down, never later
+  clock_type::time_point next_due() const
+  {
+    if (m_size == 0) {
+      return clock_type::time_point::max();
+    }
+    if (!m_expired.empty()) {
+      return m_start;
+    }
+    size_t offset = static_cast<size_t>(m_current & slot_mask);
+    size_t slot = offset + 1;
+    while (slot < slots && m_levels[0][slot].empty()) {
+      ++slot;
+    }
+    return m_start + m_tick * static_cast<clock_type::rep>(m_current - offset + slot);
+  }
+
+  // timers that are neither expired nor cancelled
+  size_t size() const { return m_size; }
+
+private:
+  static constexpr size_t levels = 4;
+  static constexpr size_t slot_bits = 6;
+  static constexpr size_t slots = size_t(1) << slot_bits;
+  static constexpr uint64_t slot_mask = slots - 1;
+  // how many ticks ahead the top level reaches
+  static constexpr uint64_t range = uint64_t(1) << (slot_bits * levels);
+
+  struct node
+  {
+    std::optional<T> item;
+    uint64_t due = 0;
+    uint64_t period = 0;
+    uint32_t generation = 0;
+  };
+
+  // rounded up, so timers never fire early
+  uint64_t ticks_until(clock_type::time_point when) const
+  {
+    if (when <= m_start) {
+      return 0;
+    }
+    auto elapsed = when - m_start;
+    return static_cast<uint64_t>((elapsed + m_tick - clock_type::duration(1)) / m_tick);
+  }
+
+  // puts a node into the slot of the lowest level that reaches its due tick, due must not be in the past
+  void place(uint32_t index)
+  {
+    uint64_t due = m_nodes[index].due;
+    uint64_t delta = due - m_current;
+    if (delta >= range) {
+      // parked in the top level until it comes into reach
+      due = m_current + range - 1;
+      delta = range - 1;
+    }
+    size_t level = 0;
+    while (level + 1 < levels && delta >= (uint64_t(1) << (slot_bits * (level + 1)))) {
+      ++level;
+    }
+    m_levels[level][static_cast<size_t>((due >> (slot_bits * level)) & slot_mask)].push_back(index);
+  }
+
+  // moves the timers of the slots that time just reached in the upper levels down
+  void cascade()
+  {
+    for (size_t level = 1; level < levels; ++level) {
+      size_t slot = static_cast<size_t>((m_current >> (slot_bits * level)) & slot_mask);
+      std::vector<uint32_t> moving;
+      moving.swap(m_levels[level][slot]);
+      for (auto index : moving) {
+        if (!m_nodes[index].item) {
+          release(index);
+        } else {
+          place(index);
+        }
+      }
+      if (slot != 0) {
+        break;
+      }
+    }
+  }
+
+  template<typename SinkT>
+  size_t fire_slot(size_t slot, SinkT& sink)
+  {
+    if (m_levels[0][slot].empty()) {
+      return 0;
+    }
+    std::vector<uint32_t> due;
+    due.swap(m_levels[0][slot]);
+    return fire(due, sink);
+  }
+
+  template<typename SinkT>
+  size_t fire(std::vector<uint32_t>& due, SinkT& sink)
+  {
+    size_t fired = 0;
+    for (auto index : due) {
+      auto& n = m_nodes[index];
+      if (!n.item) {
+        release(index);
+      } else if (n.period == 0) {
+        T item = std::move(*n.item);
+        n.item.reset();
+        --m_size;
+        release(index);
+        sink(std::move(item));
+        ++fired;
+      } else if constexpr (std::is_copy_constructible_v<T>) {
+        n.due = std::max(n.due + n.period, m_current + 1);
+        // the sink may schedule timers, which can move m_nodes
+        T item = *n.item;
+        place(index);
+        sink(std::move(item));
+        ++fired;
+      }
+    }
+    return fired;
+  }
+
+  void release(uint32_t index)
+  {
+    ++m_nodes[index].generation;
+    m_free.push_back(index);
+  }
+
+  clock_type::duration m_tick;
+  clock_type::time_point m_start;
+  // ticks since m_start that were handed out
+  uint64_t m_current = 0;
+  size_t m_size = 0;
+  std::vector<node> m_nodes;
+  std::vector<uint32_t> m_free;
+  std::vector<uint32_t> m_expired;
+  std::array<std::array<std::vector<uint32_t>, slots>, levels> m_levels;
+};
+}
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#if defined(__linux__) && __has_include(<sys/eventfd.h>)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#define HANDLEBARS_EVENTFD 1
+#endif
+
+namespace handlebars {
+inline namespace detail {
+
+// lets the consumer of a queue sleep until producers have pushed something, instead of polling.
+// producers only pay a fence and a load while nobody sleeps, the mutex is only taken to wake a sleeping consumer.
+// on linux the consumer can also ask for an eventfd which becomes readable whenever there is something to do, so the
+// queue fits into an existing epoll loop
+struct wakeup
+{
+  wakeup() = default;
+  wakeup(const wakeup&) = delete;
+  wakeup& operator=(const wakeup&) = delete;
+  ~wakeup()
+  {
+#ifdef HANDLEBARS_EVENTFD
+    int fd = m_fd.load(std::memory_order_relaxed);
+    if (fd >= 0) {
+      ::close(fd);
+    }
+#endif
+  }
+
+  // any thread, after something was pushed
+  void notify()
+  {
+    // pairs with the fence in wait_until, either the consumer sees the push or this sees the consumer waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiting.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> guard(m_lock);
+      ++m_epoch;
+      m_wake.notify_one();
+    }
+#ifdef HANDLEBARS_EVENTFD
+    int fd = m_fd.load(std::memory_order_acquire);
+    if (fd >= 0 && m_armed.load(std::memory_order_relaxed) && m_armed.exchange(false, std::memory_order_acq_rel)) {
+      uint64_t one = 1;
+      [[maybe_unused]] auto written = ::write(fd, &one, sizeof(one));
+    }
+#endif
+  }
+
+  // consumer only, after it pushed something itself. nobody waits while the consumer runs, so only the eventfd needs
+  // to become readable, if it was created
+  void notify_handle()
+  {
+#ifdef HANDLEBARS_EVENTFD
+    int fd = m_fd.load(std::memory_order_relaxed);
+    if (fd >= 0 && m_armed.load(std::memory_order_relaxed) && m_armed.exchange(false, std::memory_order_acq_rel)) {
+      uint64_t one = 1;
+      [[maybe_unused]] auto written = ::write(fd, &one, sizeof(one));
+    }
+#endif
+  }
+
+  // any thread, makes the current or the next wait_until return right away
+  void interrupt()
+  {
+    m_interrupted.store(true, std::memory_order_release);
+    notify();
+  }
+
+  // consumer only, whether interrupt was called since the last time this was asked
+  bool interrupted() { return m_interrupted.exchange(false, std::memory_order_acq_rel); }
+
+  // consumer only. returns once ready() is true, notify was called or deadline has passed
+  template<typename ReadyT>
+  void wait_until(std::chrono::steady_clock::time_point deadline, ReadyT&& ready)
+  {
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_waiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t epoch = m_epoch;
+    m_wake.wait_until(guard, deadline, [&] {
+      return m_epoch != epoch || m_interrupted.load(std::memory_order_acquire) || ready();
+    });
+    m_waiting.store(false, std::memory_order_relaxed);
+  }
+
+  // consumer only. an eventfd that notify makes readable, -1 where there is none. created by the first call
+  int event_fd()
+  {
+#ifdef HANDLEBARS_EVENTFD
+    int fd = m_fd.load(std::memory_order_relaxed);
+    if (fd < 0) {
+      fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      m_fd.store(fd, std::memory_order_release);
+    }
+    return fd;
+#else
+    return -1;
+#endif
+  }
+
+  // consumer only, before it takes what was pushed. makes the eventfd unreadable again until the next notify
+  void rearm()
+  {
+#ifdef HANDLEBARS_EVENTFD
+    int fd = m_fd.load(std::memory_order_relaxed);
+    if (fd < 0) {
+      return;
+    }
+    if (!m_armed.exchange(true, std::memory_order_acq_rel)) {
+      uint64_t count;
+      [[maybe_unused]] auto read = ::read(fd, &count, sizeof(count));
+    }
+    // pairs with the fence in notify, either the consumer sees the push or the producer sees the eventfd armed
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+  }
+
+private:
+  std::atomic<bool> m_waiting{ false };
+  std::atomic<bool> m_interrupted{ false };
+  std::mutex m_lock;
+  std::condition_variable m_wake;
+  uint64_t m_epoch = 0;
+#ifdef HANDLEBARS_EVENTFD
+  std::atomic<int> m_fd{ -1 };
+  // set while the eventfd is not readable, the first notify after rearm writes to it
+  std::atomic<bool> m_armed{ true };
+#endif
+};
+}
+}